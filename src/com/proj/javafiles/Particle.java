@@ -4,17 +4,22 @@ import java.util.List;
 import java.util.ArrayList;
 import java.math.BigDecimal;
 import java.math.RoundingMode;
+import java.util.concurrent.atomic.AtomicInteger;
 
 import javax.swing.JComponent;
 import javax.swing.SwingUtilities;
 
 public class Particle extends JComponent{
+    private static final AtomicInteger nextID = new AtomicInteger(0);
+
+    private final int id;
     private double x_coord;
     private double y_coord;
     private double velocity;
     private double angle;
 
     public Particle(double x, double y, double velocity, double angle){
+        this.id = nextID.getAndIncrement();
         this.x_coord = x;
         this.y_coord = y;
         this.angle = angle;
@@ -36,6 +41,10 @@ public class Particle extends JComponent{
         repaint();
     }
 
+    public int getID(){
+        return id;
+    }
+
     public double getXCoord(){
         return x_coord;
     }
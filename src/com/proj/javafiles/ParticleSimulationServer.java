@@ -2,16 +2,20 @@ import java.io.*;
 import java.net.*;
 import java.awt.Point;
 import java.nio.ByteBuffer;
+import java.util.ArrayDeque;
+import java.util.ArrayList;
+import java.util.HashSet;
 import java.util.List;
+import java.util.Set;
 import java.util.concurrent.*;
+import java.util.concurrent.atomic.AtomicLong;
 import java.util.stream.Collectors;
-import java.util.zip.GZIPOutputStream;
 import java.util.HashMap;
 import javax.swing.SwingUtilities;
-import java.nio.charset.StandardCharsets;
 
 import com.fasterxml.jackson.databind.JsonNode;
 import com.fasterxml.jackson.databind.ObjectMapper;
+import com.fasterxml.jackson.databind.node.ArrayNode;
 import com.fasterxml.jackson.databind.node.ObjectNode;
 
 public class ParticleSimulationServer {
@@ -19,12 +23,44 @@ public class ParticleSimulationServer {
     private ServerSocket serverSocket;
     private long timeNow;
 
+    private static final int REPLAY_LOG_SIZE = 4096;
+    private static final long SESSION_TIMEOUT_MS = 30000;
+    private static final double AOI_MARGIN = 100;
+    private static final long AOI_REFRESH_MS = 100;
+    private static final long SESSION_PURGE_MS = 5000;
+
     private final ExecutorService clientExecutor = Executors.newCachedThreadPool();
+    private final ScheduledExecutorService scheduledExecutor = Executors.newSingleThreadScheduledExecutor();
+    private final AtomicLong nextBroadcastID = new AtomicLong();
     public final List<ClientHandler> clientHandlers = new CopyOnWriteArrayList<>();
+    public final ConcurrentHashMap<Integer, ClientHandler> detachedSessions = new ConcurrentHashMap<>();
+
+    // A frame kept for replay when a client resumes its session after a dropped connection.
+    // The JSON body is kept uncompressed and encoded when written, with the codecs of the connection at that time.
+    private static class SessionFrame {
+        final long sequence;
+        final String type;
+        final long time;
+        final byte[] data;
+        final boolean snapshot;
+        // Shared by the copies of one broadcast across sessions, 0 for frames meant for this client only.
+        final long broadcast;
+
+        SessionFrame(long sequence, String type, long time, byte[] data, boolean snapshot, long broadcast) {
+            this.sequence = sequence;
+            this.type = type;
+            this.time = time;
+            this.data = data;
+            this.snapshot = snapshot;
+            this.broadcast = broadcast;
+        }
+    }
 
     public ParticleSimulationServer(int port) throws IOException {
         serverSocket = new ServerSocket(port);
         System.out.println("Server started on port: " + port);
+        scheduledExecutor.scheduleAtFixedRate(this::refreshAreasOfInterest, AOI_REFRESH_MS, AOI_REFRESH_MS, TimeUnit.MILLISECONDS);
+        scheduledExecutor.scheduleAtFixedRate(this::purgeExpiredSessions, SESSION_PURGE_MS, SESSION_PURGE_MS, TimeUnit.MILLISECONDS);
     }
 
     public void start() {
@@ -47,6 +83,7 @@ public class ParticleSimulationServer {
     public void stop() {
         try {
             clientExecutor.shutdown();
+            scheduledExecutor.shutdown();
             serverSocket.close();
         } catch (IOException e) {
             System.out.println("Error closing server: " + e.getMessage());
@@ -62,9 +99,17 @@ public class ParticleSimulationServer {
     }
 
     public void broadcastParticle(Particle p) {
+        long broadcast = nextBroadcastID.incrementAndGet();
+        detachedSessions.values().forEach(handler -> {
+            try {
+                handler.offerParticle(p, broadcast);
+            } catch (IOException e) {
+                System.err.println("Error recording state: " + e.getMessage());
+            }
+        });
         clientHandlers.forEach(handler -> {
             try {
-                handler.sendParticle(p);
+                handler.offerParticle(p, broadcast);
             } catch (IOException e) {
                 System.err.println("Error broadcasting state: " + e.getMessage());
             }
@@ -72,10 +117,18 @@ public class ParticleSimulationServer {
     }
 
     public void broadcastExplorer(Explorer explorer, int client_id) {
+        long broadcast = nextBroadcastID.incrementAndGet();
+        detachedSessions.values().forEach(handler -> {
+            try {
+                handler.offerExplorer(explorer, broadcast);
+            } catch (IOException e) {
+                System.err.println("Error recording state: " + e.getMessage());
+            }
+        });
         clientHandlers.forEach(handler -> {
             if (handler.returnID() != client_id) {
                 try {
-                    handler.sendExplorer(explorer);
+                    handler.offerExplorer(explorer, broadcast);
                 } catch (IOException e) {
                     System.err.println("Error broadcasting state: " + e.getMessage());
                 }
@@ -84,15 +137,71 @@ public class ParticleSimulationServer {
     }
 
     public void broadcastRemoveExplorer(int clientID) {
+        long broadcast = nextBroadcastID.incrementAndGet();
+        detachedSessions.values().forEach(handler -> {
+            try {
+                handler.offerRemove(clientID, broadcast);
+            } catch (IOException e) {
+                System.err.println("Error recording state: " + e.getMessage());
+            }
+        });
         clientHandlers.forEach(handler -> {
             try {
-                handler.sendID("Remove", clientID);
+                handler.offerRemove(clientID, broadcast);
             } catch (IOException e) {
                 System.err.println("Error broadcasting state: " + e.getMessage());
             }
         });
     }
 
+    // Particles that left this server's region, for every client that may still hold them.
+    public void broadcastLeave(List<Integer> ids) {
+        long broadcast = nextBroadcastID.incrementAndGet();
+        detachedSessions.values().forEach(handler -> {
+            try {
+                handler.offerLeave(ids, broadcast);
+            } catch (IOException e) {
+                System.err.println("Error recording state: " + e.getMessage());
+            }
+        });
+        clientHandlers.forEach(handler -> {
+            try {
+                handler.offerLeave(ids, broadcast);
+            } catch (IOException e) {
+                System.err.println("Error broadcasting state: " + e.getMessage());
+            }
+        });
+    }
+
+    private void refreshAreasOfInterest() {
+        if (particleSimulation == null) {
+            return;
+        }
+        // An exception escaping here would cancel the schedule, so every client is handled separately.
+        clientHandlers.forEach(handler -> {
+            try {
+                handler.refreshAreaOfInterest();
+            } catch (IOException | RuntimeException e) {
+                System.err.println("Error refreshing area of interest: " + e.getMessage());
+            }
+        });
+    }
+
+    public boolean hasAttachedHandler(int clientID) {
+        return clientHandlers.stream().anyMatch(handler -> handler.returnID() == clientID);
+    }
+
+    public void detachSession(ClientHandler handler) {
+        purgeExpiredSessions();
+        detachedSessions.put(handler.returnID(), handler);
+    }
+
+    // Expired sessions would otherwise keep logging every broadcast until another client disconnects.
+    private void purgeExpiredSessions() {
+        long now = System.currentTimeMillis();
+        detachedSessions.values().removeIf(session -> session.isExpired(now));
+    }
+
     public ParticleSimulation getParticleSimulation(){
         return particleSimulation;
     }
@@ -107,7 +216,22 @@ public class ParticleSimulationServer {
 
     public class ClientHandler implements Runnable {
         private final Socket clientSocket;
-        private final int clientID;
+        // Read by other handlers when they exit, so changes from Identity and Resume must be visible.
+        private volatile int clientID;
+        private long sequence = 0;
+        private final ArrayDeque<SessionFrame> replayLog = new ArrayDeque<>();
+        private volatile boolean detached = false;
+        // Broadcasts already in the log adopted on resume; their copies sent to this connection are dropped.
+        private Set<Long> replayedBroadcasts = new HashSet<>();
+        // The broadcast the frames being sent belong to, set by the offer methods.
+        private long currentBroadcast = 0;
+        private long detachedAt = 0;
+        // Left, bottom, width and height in particle coordinates, margin included. Null until the client sends its view.
+        private double[] areaOfInterest = null;
+        private Set<Integer> visibleParticles = null;
+        private Set<Integer> visibleExplorers = null;
+        // Codecs the client offered on this connection. Null until it does, and frames stay gzip without a codec id.
+        private Set<Byte> acceptedCodecs = null;
         private ParticleSimulationServer server;
         protected DataOutputStream dos;
         protected DataInputStream dis;
@@ -138,6 +262,10 @@ public class ParticleSimulationServer {
                     if ("ExplorerCoordinates".equals(parts[0])){
                         double x = Double.parseDouble(parts[1]);
                         double y = Double.parseDouble(parts[2]);
+                        if (parts.length >= 7) {
+                            setAreaOfInterest(Double.parseDouble(parts[3]), Double.parseDouble(parts[4]),
+                                              Double.parseDouble(parts[5]), Double.parseDouble(parts[6]));
+                        }
                         int index = particleSimulation.simulationPanel.explorerExist(clientID);
                         System.out.println("Index: " + index);
                         if (index != -1){
@@ -149,6 +277,21 @@ public class ParticleSimulationServer {
                         }
 
                         server.broadcastExplorer(new Explorer(clientID, x, y), clientID);
+                    } else if ("Resume".equals(parts[0])) {
+                        int temporaryID = clientID;
+                        resumeSession(Integer.parseInt(parts[1]), Long.parseLong(parts[2]));
+                        if (clientID != temporaryID) {
+                            // Outside the handler lock, since the removal is broadcast to every other handler.
+                            dropExplorer(temporaryID);
+                        }
+                    } else if ("Codecs".equals(parts[0])) {
+                        acceptCodecs(parts);
+                    } else if ("Identity".equals(parts[0])) {
+                        int temporaryID = clientID;
+                        adoptIdentity(Integer.parseInt(parts[1]));
+                        if (clientID != temporaryID) {
+                            dropExplorer(temporaryID);
+                        }
                     }
                     
                 }
@@ -162,9 +305,20 @@ public class ParticleSimulationServer {
                 }
                 
                 server.clientHandlers.remove(this);
-                server.getParticleSimulation().simulationPanel.removeExplorerById(clientID);
-                server.broadcastRemoveExplorer(clientID);
-                System.out.println("Client disconnected and handler removed.");
+                if (server.hasAttachedHandler(clientID)) {
+                    // The client reconnected under the same identity before this socket was found dead.
+                    // Its explorer and session now belong to the new connection.
+                    System.out.println("Client " + clientID + " already reconnected, old handler removed.");
+                } else {
+                    server.getParticleSimulation().simulationPanel.removeExplorerById(clientID);
+                    server.broadcastRemoveExplorer(clientID);
+                    synchronized (this) {
+                        detached = true;
+                        detachedAt = System.currentTimeMillis();
+                    }
+                    server.detachSession(this);
+                    System.out.println("Client disconnected and handler removed.");
+                }
             }
         } 
 
@@ -178,7 +332,7 @@ public class ParticleSimulationServer {
                 }
         
                 List<ParticleState> particleStates = particleSimulation.simulationPanel.particles.stream()
-                        .map(p -> new ParticleState(p.getXCoord(), p.getYCoord(), p.getVelocity(), p.getAngle()))
+                        .map(p -> new ParticleState(p.getID(), p.getXCoord(), p.getYCoord(), p.getVelocity(), p.getAngle()))
                         .collect(Collectors.toList());
 
                 server.setTime();
@@ -204,42 +358,305 @@ public class ParticleSimulationServer {
             }
         
             ObjectMapper mapper = new ObjectMapper();
-            String json = mapper.writeValueAsString(state);
-        
-            ByteArrayOutputStream baos = new ByteArrayOutputStream();
-            try (GZIPOutputStream gzipOut = new GZIPOutputStream(baos)) {
-                gzipOut.write(json.getBytes(StandardCharsets.UTF_8));
-            }
-            return baos.toByteArray();
+            return mapper.writeValueAsBytes(state);
         }        
 
         public byte[] serializeParticle(Particle p) throws IOException {
-            ParticleState state = new ParticleState(p.getXCoord(), p.getYCoord(), p.getVelocity(), p.getAngle());
+            ParticleState state = new ParticleState(p.getID(), p.getXCoord(), p.getYCoord(), p.getVelocity(), p.getAngle());
             server.setTime();
 
             ObjectMapper mapper = new ObjectMapper();
-            String json = mapper.writeValueAsString(state);
-        
-            ByteArrayOutputStream baos = new ByteArrayOutputStream();
-            try (GZIPOutputStream gzipOut = new GZIPOutputStream(baos)) {
-                gzipOut.write(json.getBytes(StandardCharsets.UTF_8));
-            }
-            return baos.toByteArray();
+            return mapper.writeValueAsBytes(state);
         }   
 
         public byte[] serializeExplorer(Explorer e) throws IOException {
             ExplorerState state = new ExplorerState(e.getClientID(), e.getXCoord(), e.getYCoord());
 
             ObjectMapper mapper = new ObjectMapper();
-            String json = mapper.writeValueAsString(state);
-        
-            ByteArrayOutputStream baos = new ByteArrayOutputStream();
-            try (GZIPOutputStream gzipOut = new GZIPOutputStream(baos)) {
-                gzipOut.write(json.getBytes(StandardCharsets.UTF_8));
-            }
-            return baos.toByteArray();
+            return mapper.writeValueAsBytes(state);
         }   
 
+        private synchronized void resumeSession(int previousID, long lastSequence) throws IOException {
+            ClientHandler previous = server.detachedSessions.remove(previousID);
+
+            if (previous == null || !previous.canReplayFrom(lastSequence)) {
+                System.out.println("Session " + previousID + " cannot be resumed from " + lastSequence + ", sending full state.");
+                sendSession(false);
+                sendState();
+                return;
+            }
+
+            Set<Long> replayed = new HashSet<>();
+            synchronized (previous) {
+                for (SessionFrame frame : previous.replayLog) {
+                    if (frame.broadcast != 0) {
+                        replayed.add(frame.broadcast);
+                    }
+                }
+            }
+
+            // Anything sent to this connection before the resume request still has to reach the client, except
+            // the greeting, the full snapshot, and broadcasts the detached session logged too and replays below.
+            List<SessionFrame> pending = new ArrayList<>();
+            for (SessionFrame frame : replayLog) {
+                if (!frame.snapshot && !"ID".equals(frame.type) && !replayed.contains(frame.broadcast)) {
+                    pending.add(frame);
+                }
+            }
+
+            synchronized (previous) {
+                clientID = previousID;
+                sequence = previous.sequence;
+                replayLog.clear();
+                replayLog.addAll(previous.replayLog);
+                areaOfInterest = previous.areaOfInterest;
+                visibleParticles = previous.visibleParticles;
+                visibleExplorers = previous.visibleExplorers;
+            }
+            // A broadcast still on its way here may already have reached the detached session.
+            replayedBroadcasts = replayed;
+
+            sendSession(true);
+            for (SessionFrame frame : replayLog) {
+                if (frame.sequence > lastSequence) {
+                    writeFrame(frame);
+                }
+            }
+            for (SessionFrame frame : pending) {
+                currentBroadcast = frame.broadcast;
+                sendTypedMessage(frame.type, frame.time, frame.data, false);
+            }
+            currentBroadcast = 0;
+            System.out.println("Session " + clientID + " resumed after sequence " + lastSequence);
+        }
+
+        // A client connected to several region servers announces one identity to all of them,
+        // so its explorer carries the same ID whichever server reports it.
+        private synchronized void adoptIdentity(int identity) throws IOException {
+            if (identity == clientID) {
+                return;
+            }
+            clientID = identity;
+            sendID("ID", clientID);
+        }
+
+        private synchronized boolean canReplayFrom(long lastSequence) {
+            return !isExpired(System.currentTimeMillis()) && lastSequence <= sequence
+                && (replayLog.isEmpty() || replayLog.peekFirst().sequence <= lastSequence + 1);
+        }
+
+        public synchronized boolean isExpired(long now) {
+            return detached && now - detachedAt > SESSION_TIMEOUT_MS;
+        }
+
+        private void dropExplorer(int id) {
+            if (particleSimulation.simulationPanel.explorerExist(id) != -1) {
+                particleSimulation.simulationPanel.removeExplorerById(id);
+                server.broadcastRemoveExplorer(id);
+            }
+        }
+
+        private void sendSession(boolean resumed) throws IOException {
+            ObjectMapper mapper = new ObjectMapper();
+            ObjectNode session = mapper.createObjectNode();
+            session.put("clientID", clientID);
+            session.put("resumed", resumed);
+
+            // Control frame: carries no sequence number and is not logged for replay.
+            writeFrame(new SessionFrame(0, "Session", System.currentTimeMillis(), mapper.writeValueAsBytes(session), false, 0));
+        }
+
+        // Answers with the codecs it will use. The answer is the last frame without a codec id, so nothing
+        // else may be written between it and the switch.
+        private synchronized void acceptCodecs(String[] parts) throws IOException {
+            Set<Byte> codecs = new HashSet<>();
+            codecs.add(PayloadCodec.GZIP);
+            for (int i = 1; i < parts.length; i++) {
+                byte codec = PayloadCodec.fromName(parts[i]);
+                if (codec >= 0) {
+                    codecs.add(codec);
+                }
+            }
+
+            ObjectMapper mapper = new ObjectMapper();
+            ObjectNode answer = mapper.createObjectNode();
+            ArrayNode names = answer.putArray("codecs");
+            for (Byte codec : codecs) {
+                names.add(PayloadCodec.getName(codec));
+            }
+
+            writeFrame(new SessionFrame(0, "Codec", System.currentTimeMillis(), mapper.writeValueAsBytes(answer), false, 0));
+            acceptedCodecs = codecs;
+        }
+
+        private synchronized void setAreaOfInterest(double left, double bottom, double width, double height) {
+            if (areaOfInterest == null) {
+                // Until now the client received everything, so it already holds every particle and explorer.
+                visibleParticles = new HashSet<>();
+                synchronized (particleSimulation.simulationPanel.particles) {
+                    for (Particle p : particleSimulation.simulationPanel.particles) {
+                        visibleParticles.add(p.getID());
+                    }
+                }
+                visibleExplorers = new HashSet<>();
+                synchronized (particleSimulation.simulationPanel.explorers) {
+                    for (Explorer e : particleSimulation.simulationPanel.explorers) {
+                        if (e.getClientID() != clientID) {
+                            visibleExplorers.add(e.getClientID());
+                        }
+                    }
+                }
+            }
+            areaOfInterest = new double[] { left - AOI_MARGIN, bottom - AOI_MARGIN, width + 2 * AOI_MARGIN, height + 2 * AOI_MARGIN };
+        }
+
+        private boolean inAreaOfInterest(double x, double y) {
+            return areaOfInterest == null
+                || (x >= areaOfInterest[0] && x <= areaOfInterest[0] + areaOfInterest[2]
+                    && y >= areaOfInterest[1] && y <= areaOfInterest[1] + areaOfInterest[3]);
+        }
+
+        public synchronized void offerParticle(Particle p, long broadcast) throws IOException {
+            if (areaOfInterest != null) {
+                if (!inAreaOfInterest(p.getXCoord(), p.getYCoord())) {
+                    return;
+                }
+                visibleParticles.add(p.getID());
+            }
+            currentBroadcast = broadcast;
+            try {
+                sendParticle(p);
+            } finally {
+                currentBroadcast = 0;
+            }
+        }
+
+        public synchronized void offerExplorer(Explorer explorer, long broadcast) throws IOException {
+            currentBroadcast = broadcast;
+            try {
+                offerExplorer(explorer);
+            } finally {
+                currentBroadcast = 0;
+            }
+        }
+
+        public synchronized void offerRemove(int id, long broadcast) throws IOException {
+            currentBroadcast = broadcast;
+            try {
+                sendID("Remove", id);
+            } finally {
+                currentBroadcast = 0;
+            }
+        }
+
+        // With an area of interest only the ids the client was sent are named.
+        public synchronized void offerLeave(List<Integer> ids, long broadcast) throws IOException {
+            List<Integer> held = ids;
+            if (areaOfInterest != null) {
+                held = new ArrayList<>();
+                for (Integer id : ids) {
+                    if (visibleParticles.remove(id)) {
+                        held.add(id);
+                    }
+                }
+            }
+            if (held.isEmpty()) {
+                return;
+            }
+
+            HashMap<String, List<Integer>> leave = new HashMap<>();
+            leave.put("ids", held);
+            currentBroadcast = broadcast;
+            try {
+                sendTypedMessage("Leave", System.currentTimeMillis(), serializeJson(leave), false);
+            } finally {
+                currentBroadcast = 0;
+            }
+        }
+
+        private void offerExplorer(Explorer explorer) throws IOException {
+            if (areaOfInterest != null) {
+                int id = explorer.getClientID();
+                // Explorer coordinates are screen coordinates, the area of interest uses particle coordinates.
+                if (!inAreaOfInterest(explorer.getXCoord(), 720 - explorer.getYCoord())) {
+                    if (visibleExplorers.remove(id)) {
+                        sendID("Remove", id);
+                    }
+                    return;
+                }
+                visibleExplorers.add(id);
+            }
+            sendExplorer(explorer);
+        }
+
+        // Sends the particles and explorers that entered the client's area of interest and the ids of those that left.
+        public synchronized void refreshAreaOfInterest() throws IOException {
+            if (areaOfInterest == null || detached) {
+                return;
+            }
+
+            List<ParticleState> enteredParticles = new ArrayList<>();
+            Set<Integer> insideParticles = new HashSet<>();
+            synchronized (particleSimulation.simulationPanel.particles) {
+                for (Particle p : particleSimulation.simulationPanel.particles) {
+                    if (inAreaOfInterest(p.getXCoord(), p.getYCoord())) {
+                        insideParticles.add(p.getID());
+                        if (!visibleParticles.contains(p.getID())) {
+                            enteredParticles.add(new ParticleState(p.getID(), p.getXCoord(), p.getYCoord(), p.getVelocity(), p.getAngle()));
+                        }
+                    }
+                }
+            }
+            List<Integer> leftParticles = new ArrayList<>();
+            for (Integer id : visibleParticles) {
+                if (!insideParticles.contains(id)) {
+                    leftParticles.add(id);
+                }
+            }
+            visibleParticles = insideParticles;
+
+            List<ExplorerState> enteredExplorers = new ArrayList<>();
+            Set<Integer> insideExplorers = new HashSet<>();
+            synchronized (particleSimulation.simulationPanel.explorers) {
+                for (Explorer e : particleSimulation.simulationPanel.explorers) {
+                    if (e.getClientID() != clientID && inAreaOfInterest(e.getXCoord(), 720 - e.getYCoord())) {
+                        insideExplorers.add(e.getClientID());
+                        if (!visibleExplorers.contains(e.getClientID())) {
+                            enteredExplorers.add(new ExplorerState(e.getClientID(), e.getXCoord(), e.getYCoord()));
+                        }
+                    }
+                }
+            }
+            List<Integer> leftExplorers = new ArrayList<>();
+            for (Integer id : visibleExplorers) {
+                if (!insideExplorers.contains(id)) {
+                    leftExplorers.add(id);
+                }
+            }
+            visibleExplorers = insideExplorers;
+
+            long now = System.currentTimeMillis();
+            if (!enteredParticles.isEmpty()) {
+                sendTypedMessage("Particles", now, serializeJson(enteredParticles), false);
+            }
+            if (!leftParticles.isEmpty()) {
+                HashMap<String, List<Integer>> leave = new HashMap<>();
+                leave.put("ids", leftParticles);
+                sendTypedMessage("Leave", now, serializeJson(leave), false);
+            }
+            if (!enteredExplorers.isEmpty()) {
+                sendTypedMessage("Explorers", now, serializeJson(enteredExplorers), false);
+            }
+            for (Integer id : leftExplorers) {
+                sendID("Remove", id);
+            }
+        }
+
+        private byte[] serializeJson(Object state) throws IOException {
+            ObjectMapper mapper = new ObjectMapper();
+            return mapper.writeValueAsBytes(state);
+        }
+
         public void sendState() throws IOException {
             // Example type indicators
             String typeParticle = "Particles";
@@ -248,12 +665,13 @@ public class ParticleSimulationServer {
             byte[] serializedParticleState = serializeSimulationState(typeParticle);
             byte[] serializedExplorerState = serializeSimulationState(typeExplorer);
         
+            // Stamped when sent: the shared server time is whatever the last serialization set, or 0 before any.
             if (serializedParticleState.length > 0) {
-                sendTypedMessage(typeParticle, serializedParticleState);
+                sendTypedMessage(typeParticle, System.currentTimeMillis(), serializedParticleState, true);
             }
             
             if (serializedExplorerState.length > 0) {
-                sendTypedMessage(typeExplorer, serializedExplorerState);
+                sendTypedMessage(typeExplorer, System.currentTimeMillis(), serializedExplorerState, true);
             }
         }
 
@@ -273,7 +691,7 @@ public class ParticleSimulationServer {
             byte[] serializedExplorerState = serializeExplorer(e);
             
             if (serializedExplorerState.length > 0) {
-                sendTypedMessage(typeExplorer, serializedExplorerState);
+                sendTypedMessage(typeExplorer, System.currentTimeMillis(), serializedExplorerState, false);
             }
         }
 
@@ -281,25 +699,47 @@ public class ParticleSimulationServer {
             ObjectMapper mapper = new ObjectMapper();
             HashMap<String, Integer> clientIDMap = new HashMap<>();
             clientIDMap.put("clientID", ClientID);
-            String json = mapper.writeValueAsString(clientIDMap);
-            
-            ByteArrayOutputStream baos = new ByteArrayOutputStream();
-            try (GZIPOutputStream gzipOut = new GZIPOutputStream(baos)) {
-                gzipOut.write(json.getBytes(StandardCharsets.UTF_8));
-            } 
             
-            sendTypedMessage(type, baos.toByteArray());
+            sendTypedMessage(type, System.currentTimeMillis(), mapper.writeValueAsBytes(clientIDMap), false);
         }
         
         private void sendTypedMessage(String type, byte[] data) throws IOException {
+            sendTypedMessage(type, System.currentTimeMillis(), data, false);
+        }
+
+        private synchronized void sendTypedMessage(String type, long time, byte[] data, boolean snapshot) throws IOException {
+            if (currentBroadcast != 0 && replayedBroadcasts.contains(currentBroadcast)) {
+                return;
+            }
+            SessionFrame frame = new SessionFrame(++sequence, type, time, data, snapshot, currentBroadcast);
+            replayLog.addLast(frame);
+            while (replayLog.size() > REPLAY_LOG_SIZE) {
+                replayLog.removeFirst();
+            }
+
+            if (!detached) {
+                writeFrame(frame);
+            }
+        }
+
+        private synchronized void writeFrame(SessionFrame frame) throws IOException {
+            byte codec = acceptedCodecs == null ? PayloadCodec.GZIP : PayloadCodec.choose(acceptedCodecs, frame.data.length);
+            byte[] data = PayloadCodec.encode(codec, frame.data);
             dos.flush();
             
-            dos.writeUTF(type);
+            dos.writeUTF(frame.type);
             dos.flush();
 
-            dos.writeLong(server.getTime());
+            dos.writeLong(frame.time);
             dos.flush();
 
+            dos.writeLong(frame.sequence);
+            dos.flush();
+
+            if (acceptedCodecs != null) {
+                dos.writeByte(codec);
+            }
+
             ByteBuffer buffer = ByteBuffer.allocate(4);
             buffer.putInt(data.length);
             dos.write(buffer.array());
@@ -324,12 +764,19 @@ public class ParticleSimulationServer {
         ObjectMapper mapper = new ObjectMapper();
         try {
             JsonNode config = mapper.readTree(new File(configFile));
-            int port = config.get("port").asInt(); 
+            // A port argument overrides config.json so several region servers can run side by side.
+            int port = args.length > 0 ? Integer.parseInt(args[0]) : config.get("port").asInt(); 
             
             ParticleSimulationServer server = new ParticleSimulationServer(port);
             new Thread(server::start).start();
             
             particleSimulation = new ParticleSimulation();
+            // Optional region as left, bottom, width and height, matching the client's "regions" entry for this port.
+            if (args.length >= 5) {
+                particleSimulation.simulationPanel.setRegion(Double.parseDouble(args[1]), Double.parseDouble(args[2]),
+                                                             Double.parseDouble(args[3]), Double.parseDouble(args[4]));
+                System.out.println("Serving region " + args[1] + "," + args[2] + " " + args[3] + "x" + args[4]);
+            }
             particleSimulation.simulationPanel.setServer(server);
             displayGUI();
         } catch (IOException e) {
@@ -3,8 +3,10 @@ public class ParticleState {
     private double y_coord;
     private double velocity;
     private double angle;
+    private int id;
 
-    public ParticleState(double x, double y, double velocity, double angle) {
+    public ParticleState(int id, double x, double y, double velocity, double angle) {
+        this.id = id;
         this.x_coord = x;
         this.y_coord = y;
         this.velocity = velocity;
@@ -12,6 +14,10 @@ public class ParticleState {
     }
 
     // Getters
+    public int getID() {
+        return id;
+    }
+
     public double getXCoord() {
         return x_coord;
     }
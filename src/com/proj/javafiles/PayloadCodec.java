@@ -0,0 +1,177 @@
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
+import java.util.Set;
+import java.util.zip.Deflater;
+import java.util.zip.GZIPOutputStream;
+
+// Encodes frame payloads for the wire. Ids, names and the dictionary must match PayloadCodec.hpp on the client.
+public final class PayloadCodec {
+    public static final byte RAW = 0;
+    public static final byte GZIP = 1;
+    public static final byte LZ4 = 2;
+    public static final byte DICTIONARY = 3;
+
+    // Payloads up to this size are sent as is; compressing them costs more than the bytes it saves.
+    private static final int RAW_MAX_BYTES = 32;
+    // Up to this size the preset dictionary beats the other codecs, since the payload alone has little to repeat.
+    private static final int DICTIONARY_MAX_BYTES = 2048;
+
+    // Fragments of the payloads the server sends, most frequent last since deflate reaches
+    // the end of the dictionary with the shortest distances.
+    private static final byte[] DICTIONARY_BYTES = (
+        "{\"resumed\":false,\"codecs\":[\"raw\",\"gzip\",\"lz4\",\"dict\"]}{\"ids\":[{\"clientID\":"
+        + "{\"xcoord\":0.0,\"ycoord\":0.0,\"clientID\":1}"
+        + "[{\"id\":0,\"xcoord\":0.0,\"ycoord\":0.0,\"velocity\":0.0,\"angle\":0.0},"
+        + "{\"id\":1,\"xcoord\":1.0,\"ycoord\":1.0,\"velocity\":1.0,\"angle\":1.0},{\"id\":"
+    ).getBytes(StandardCharsets.UTF_8);
+
+    private static final int LZ4_HASH_BITS = 12;
+    private static final int LZ4_MIN_MATCH = 4;
+    private static final int LZ4_LAST_LITERALS = 5;
+    private static final int LZ4_MATCH_SEARCH_LIMIT = 12;
+    private static final int LZ4_MAX_OFFSET = 65535;
+
+    private PayloadCodec() {
+    }
+
+    public static byte fromName(String name) {
+        switch (name) {
+            case "raw": return RAW;
+            case "gzip": return GZIP;
+            case "lz4": return LZ4;
+            case "dict": return DICTIONARY;
+            default: return -1;
+        }
+    }
+
+    public static String getName(byte codec) {
+        switch (codec) {
+            case RAW: return "raw";
+            case LZ4: return "lz4";
+            case DICTIONARY: return "dict";
+            default: return "gzip";
+        }
+    }
+
+    // Picks the codec for one payload by its size, out of the ones the client accepted. Gzip is always understood.
+    public static byte choose(Set<Byte> accepted, int length) {
+        if (length <= RAW_MAX_BYTES && accepted.contains(RAW)) {
+            return RAW;
+        }
+        if (length <= DICTIONARY_MAX_BYTES && accepted.contains(DICTIONARY)) {
+            return DICTIONARY;
+        }
+        if (accepted.contains(LZ4)) {
+            return LZ4;
+        }
+        return GZIP;
+    }
+
+    public static byte[] encode(byte codec, byte[] data) throws IOException {
+        switch (codec) {
+            case RAW: return data;
+            case LZ4: return compressLZ4(data);
+            case DICTIONARY: return deflateWithDictionary(data);
+            default: return gzip(data);
+        }
+    }
+
+    public static byte[] gzip(byte[] data) throws IOException {
+        ByteArrayOutputStream baos = new ByteArrayOutputStream();
+        try (GZIPOutputStream gzipOut = new GZIPOutputStream(baos)) {
+            gzipOut.write(data);
+        }
+        return baos.toByteArray();
+    }
+
+    // zlib format, whose header carries the dictionary checksum so the client can detect a mismatch.
+    private static byte[] deflateWithDictionary(byte[] data) {
+        Deflater deflater = new Deflater();
+        deflater.setDictionary(DICTIONARY_BYTES);
+        deflater.setInput(data);
+        deflater.finish();
+
+        ByteArrayOutputStream baos = new ByteArrayOutputStream(data.length / 2 + 16);
+        byte[] buffer = new byte[4096];
+        while (!deflater.finished()) {
+            int length = deflater.deflate(buffer);
+            baos.write(buffer, 0, length);
+        }
+        deflater.end();
+        return baos.toByteArray();
+    }
+
+    // A single LZ4 block with a greedy hash-table match finder, prefixed with the decoded size as a big-endian int.
+    private static byte[] compressLZ4(byte[] src) {
+        ByteArrayOutputStream out = new ByteArrayOutputStream(src.length / 2 + 16);
+        out.write(src.length >>> 24);
+        out.write(src.length >>> 16);
+        out.write(src.length >>> 8);
+        out.write(src.length);
+
+        int[] table = new int[1 << LZ4_HASH_BITS];
+        Arrays.fill(table, -1);
+        int anchor = 0;
+        int position = 0;
+        int searchEnd = src.length - LZ4_MATCH_SEARCH_LIMIT;
+        int matchEnd = src.length - LZ4_LAST_LITERALS;
+
+        while (position < searchEnd) {
+            int sequence = readInt(src, position);
+            int hash = (sequence * -1640531535) >>> (32 - LZ4_HASH_BITS);
+            int candidate = table[hash];
+            table[hash] = position;
+
+            if (candidate < 0 || position - candidate > LZ4_MAX_OFFSET || readInt(src, candidate) != sequence) {
+                position++;
+                continue;
+            }
+
+            int matchLength = LZ4_MIN_MATCH;
+            while (position + matchLength < matchEnd && src[candidate + matchLength] == src[position + matchLength]) {
+                matchLength++;
+            }
+
+            writeLZ4Sequence(out, src, anchor, position - anchor, position - candidate, matchLength);
+            position += matchLength;
+            anchor = position;
+        }
+
+        writeLZ4Sequence(out, src, anchor, src.length - anchor, 0, 0);
+        return out.toByteArray();
+    }
+
+    // A match length of 0 writes the closing literals-only sequence.
+    private static void writeLZ4Sequence(ByteArrayOutputStream out, byte[] src, int literalStart, int literalLength,
+                                         int offset, int matchLength) {
+        int extraMatch = matchLength - LZ4_MIN_MATCH;
+        int token = (Math.min(literalLength, 15) << 4) | (matchLength > 0 ? Math.min(extraMatch, 15) : 0);
+        out.write(token);
+        writeLZ4Length(out, literalLength);
+        out.write(src, literalStart, literalLength);
+
+        if (matchLength > 0) {
+            out.write(offset);
+            out.write(offset >>> 8);
+            writeLZ4Length(out, extraMatch);
+        }
+    }
+
+    private static void writeLZ4Length(ByteArrayOutputStream out, int length) {
+        if (length < 15) {
+            return;
+        }
+        length -= 15;
+        while (length >= 255) {
+            out.write(255);
+            length -= 255;
+        }
+        out.write(length);
+    }
+
+    private static int readInt(byte[] src, int index) {
+        return (src[index] & 0xFF) | (src[index + 1] & 0xFF) << 8 | (src[index + 2] & 0xFF) << 16 | (src[index + 3] & 0xFF) << 24;
+    }
+}
@@ -7,6 +7,7 @@ import java.util.ArrayList;
 import java.util.Collections;
 import java.util.Iterator;
 import java.util.List;
+import java.util.stream.Collectors;
 import java.util.concurrent.ExecutorService;
 import java.util.concurrent.Executors;
 import java.awt.geom.AffineTransform;
@@ -30,6 +31,13 @@ public class SimulationPanel extends JPanel{
 
     private ParticleSimulationServer server;
 
+    // The part of the world this server owns, in particle coordinates. The whole world unless the
+    // server was started for one region.
+    private volatile double regionLeft = 0;
+    private volatile double regionBottom = 0;
+    private volatile double regionWidth = SIMULATION_WIDTH;
+    private volatile double regionHeight = SIMULATION_HEIGHT;
+
     public SimulationPanel(){
         setBounds(50, 50, SIMULATION_WIDTH, SIMULATION_HEIGHT);
         setBackground(Color.WHITE);
@@ -51,7 +59,27 @@ public class SimulationPanel extends JPanel{
         this.server = server;
     }
 
+    public void setRegion(double left, double bottom, double width, double height){
+        regionLeft = left;
+        regionBottom = bottom;
+        regionWidth = width;
+        regionHeight = height;
+    }
+
+    // Half-open like the client's region bounds, so a point on a shared edge belongs to one region only.
+    public boolean inRegion(double x, double y){
+        return x >= regionLeft && x < regionLeft + regionWidth && y >= regionBottom && y < regionBottom + regionHeight;
+    }
+
+    private boolean inWorld(double x, double y){
+        return x >= 0 && x < SIMULATION_WIDTH && y >= 0 && y < SIMULATION_HEIGHT;
+    }
+
     public void opt1Add(double x, double y, double angle, double velocity){
+        if (!inRegion(x, y)) {
+            System.err.println("Particle at " + x + ", " + y + " is outside this server's region, not added.");
+            return;
+        }
         Particle particle = new Particle(x, y, velocity, angle);
         this.particles.add(particle);
         particle.setBounds(0,0, 1280,720);
@@ -179,9 +207,25 @@ public class SimulationPanel extends JPanel{
     }
     
     public void updateSimulation(){
+        List<Particle> left = new ArrayList<>();
         synchronized (this.particles){
-            for (Particle particle : this.particles) {
+            Iterator<Particle> iterator = this.particles.iterator();
+            while (iterator.hasNext()) {
+                Particle particle = iterator.next();
                 particle.updatePosition(0.1);
+                // Moved into another region. There is no handoff between servers, so the particle ends here;
+                // one just past the world edge is still bouncing back and stays.
+                if (!inRegion(particle.getXCoord(), particle.getYCoord()) && inWorld(particle.getXCoord(), particle.getYCoord())) {
+                    iterator.remove();
+                    left.add(particle);
+                }
+            }
+        }
+
+        if (!left.isEmpty()) {
+            SwingUtilities.invokeLater(() -> left.forEach(this::remove));
+            if (server != null) {
+                server.broadcastLeave(left.stream().map(Particle::getID).collect(Collectors.toList()));
             }
         }
         
@@ -0,0 +1,282 @@
+#include "ClientServer.hpp"
+
+#include <boost/asio.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <random>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <boost/thread.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/system/error_code.hpp>
+
+#include "ParticleSimulation.hpp"
+#include "ConnectionManager.hpp"
+#include "DecodePipeline.hpp"
+#include "PayloadCodec.hpp"
+#include "SpatialOrder.hpp"
+
+namespace fs = boost::filesystem;
+using json = nlohmann::json;
+
+namespace {
+    // Servers number connections by port, so identities above the port range never collide with them.
+    const int CLIENT_IDENTITY_MIN = 65536;
+    // Frames per region that may be read ahead of the apply stage before the reader waits.
+    const size_t DEFAULT_MAX_FRAMES_IN_FLIGHT = 64;
+
+    struct RegionConfig {
+        std::string ip;
+        std::string port;
+        sf::FloatRect bounds;
+    };
+
+    // Applies one decoded frame from a region's server, in the order the frames were read.
+    void applyFrame(ParticleSimulation& simulation, DecodedFrame& decoded, size_t regionIndex) {
+        if ("ID" == decoded.type){
+            if (regionIndex == 0) {
+                simulation.setID(decoded.data);
+            }
+        } else if ("Session" == decoded.type){
+            if (!decoded.data.value("resumed", false)) {
+                simulation.resetRegion(regionIndex);
+            }
+            if (regionIndex == 0) {
+                simulation.setID(decoded.data);
+            }
+        } else if ("Particles" == decoded.type){
+            simulation.addParticles(decoded.particles, regionIndex);
+        } else if ("Explorers" == decoded.type){
+            simulation.addOtherExplorer(decoded.data, regionIndex);
+        } else if ("Remove" == decoded.type){
+            simulation.removeExplorer(decoded.data, regionIndex);
+        } else if ("Leave" == decoded.type){
+            simulation.removeParticles(decoded.data, regionIndex);
+        } 
+    }
+
+    // Reads frames from one region's server until the simulation stops, reconnecting on errors.
+    // Only framing happens here; decoding and applying are left to the pipeline.
+    void readFromServer(ParticleSimulation& simulation, ConnectionManager& connection, DecodePipeline& pipeline,
+                        PayloadRecorder* recorder, size_t regionIndex) {
+        try {
+            boost::system::error_code ec;
+            ServerFrame frame;
+
+            while (simulation.getIsRunning()) {
+                if (!connection.readFrame(frame, ec)) {
+                    std::cerr << "Read error on region " << regionIndex << ": " << ec.message() << std::endl;
+                    connection.disconnect();
+
+                    // The simulation keeps running locally while the connection is re-established.
+                    if (!connection.connectWithBackoff(simulation)) {
+                        break;
+                    }
+                    if (connection.hasSession()) {
+                        connection.requestResume();
+                    }
+                    if (simulation.getSimulationPanel().getExplorer() != nullptr) {
+                        simulation.getSimulationPanel().getExplorer()->markMoved();
+                    }
+                    continue;
+                }
+
+                if (recorder != nullptr) {
+                    recorder->record(frame.type, frame.codec, frame.payload);
+                }
+
+                if (!connection.shouldApply(frame)) {
+                    continue;
+                }
+
+                long elapsedTime = getTimeDifference(frame.serverTime);
+
+                // Session state decides which of the following frames are accepted, so these small
+                // control frames are decoded right away and only their effect goes through the pipeline.
+                if ("ID" == frame.type || "Session" == frame.type || "Codec" == frame.type) {
+                    try {
+                        auto jsonParsed = json::parse(decodePayload(frame.codec, frame.payload));
+                        if ("Codec" == frame.type) {
+                            // Only changes how this connection reads frames, the simulation never sees it.
+                            connection.acceptCodecs(jsonParsed);
+                            continue;
+                        }
+                        if ("ID" == frame.type) {
+                            connection.setClientID(jsonParsed.value("clientID", -1));
+                        } else {
+                            connection.applySession(jsonParsed);
+                        }
+                        pipeline.submitDecoded(frame.type, jsonParsed);
+                    } catch (const std::exception& e) {
+                        std::cerr << "Error handling JSON data: " << e.what() << std::endl;
+                    }
+                    continue;
+                }
+
+                pipeline.submit(frame, elapsedTime);
+            }
+        } catch (std::exception& e) {
+            std::cerr << "Exception: " << e.what() << std::endl;
+        } 
+    }
+}
+
+int main() {
+    std::cout << "Current Path: " << fs::current_path() << std::endl;
+    
+    std::string configPath = clientConfigPath();
+
+    std::ifstream configFile(configPath);
+    json configJson;
+
+    if (configFile.is_open()) {
+        configFile >> configJson;
+        configFile.close();
+    } else {
+        std::cerr << "Could not open config file: " << configPath << " - " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    std::string server_ip = configJson.value("ip", "127.0.0.1"); 
+    std::string server_port = configJson.value("port", "1234");
+    int reconnectInitialMs = configJson.value("reconnectInitialMs", 250);
+    int reconnectMaxMs = configJson.value("reconnectMaxMs", 8000);
+
+    // Codecs offered to every server; gzip is always understood, even without negotiation.
+    std::vector<std::string> codecs;
+    for (const auto& codec : configJson.value("codecs", json::array({ "raw", "gzip", "lz4", "dict" }))) {
+        std::string name = codec.get<std::string>();
+        if (findPayloadCodec(name) == nullptr) {
+            std::cerr << "Ignoring unknown codec " << name << std::endl;
+            continue;
+        }
+        codecs.push_back(name);
+    }
+
+    std::unique_ptr<PayloadRecorder> recorder;
+    if (configJson.contains("recordPayloads")) {
+        recorder = std::make_unique<PayloadRecorder>(configJson["recordPayloads"].get<std::string>());
+        if (!recorder->isOpen()) {
+            recorder.reset();
+        }
+    }
+
+    // Without a "regions" list the whole world is one region served by ip/port.
+    std::vector<RegionConfig> regions;
+    if (configJson.contains("regions") && configJson["regions"].is_array()) {
+        for (const auto& region : configJson["regions"]) {
+            regions.push_back({ region.value("ip", server_ip), region.value("port", server_port),
+                                sf::FloatRect(region.value("x", 0.0f), region.value("y", 0.0f),
+                                              region.value("width", 1280.0f), region.value("height", 720.0f)) });
+        }
+    }
+    if (regions.empty()) {
+        regions.push_back({ server_ip, server_port, sf::FloatRect(0, 0, 1280, 720) });
+    }
+
+    ParticleSimulation simulation;
+    simulation.setRenderPacing(configJson.value("targetFPS", 60), configJson.value("vsync", false));
+
+    SpaceFillingCurve reorderCurve = SpaceFillingCurve::Hilbert;
+    std::string reorderCurveName = configJson.value("reorderCurve", "hilbert");
+    if (!parseSpaceFillingCurve(reorderCurveName, reorderCurve)) {
+        std::cerr << "Unknown reorderCurve " << reorderCurveName << ", using hilbert" << std::endl;
+    }
+    simulation.setParticleReordering(configJson.value("reorderInterval", 0), reorderCurve);
+
+    // One identity for every region's server, so each of them reports this client's explorer under the same ID.
+    std::random_device randomDevice;
+    int identity = std::uniform_int_distribution<int>(CLIENT_IDENTITY_MIN, std::numeric_limits<int>::max())(randomDevice);
+
+    std::vector<sf::FloatRect> regionBounds;
+    std::vector<std::unique_ptr<ConnectionManager>> connections;
+    for (const auto& region : regions) {
+        std::cout << "Configured to connect to server at " << region.ip << ":" << region.port << " for region "
+                  << region.bounds.left << "," << region.bounds.top << " "
+                  << region.bounds.width << "x" << region.bounds.height << std::endl;
+        regionBounds.push_back(region.bounds);
+        connections.push_back(std::make_unique<ConnectionManager>(region.ip, region.port, reconnectInitialMs, reconnectMaxMs));
+        connections.back()->setCodecs(codecs);
+        connections.back()->setIdentity(identity);
+    }
+    simulation.setRegions(regionBounds);
+
+    for (auto& connection : connections) {
+        if (!connection->connectWithBackoff(simulation)) {
+            std::cerr << "Failed to connect to server." << std::endl;
+            return 1;
+        }
+    }
+
+    boost::thread simThread([&simulation](){
+        simulation.run();
+        std::cout << "Close 2" << std::endl;
+    });
+
+    boost::thread simUpdateThread([&simulation](){
+        simulation.updateSimulationLoop();
+        std::cout << "Close 1" << std::endl;
+    });
+
+
+    boost::thread explorerThread([&connections, &simulation](){
+        while (simulation.getIsRunning()) {
+            if (simulation.getSimulationPanel().getExplorer() != nullptr && simulation.getSimulationPanel().getExplorer()->getMove()){
+                bool sent = true;
+                for (auto& connection : connections) {
+                    sent = sendExplorerToServer(*connection, simulation.getSimulationPanel()) && sent;
+                }
+                if (sent) {
+                    simulation.getSimulationPanel().getExplorer()->revertMove();
+                }
+            }
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1000));
+        }
+        std::cout << "Close 3" << std::endl;
+    });
+
+    std::cout << "Starting to read from server." << std::endl;
+
+    size_t maxFramesInFlight = configJson.value("maxFramesInFlight", DEFAULT_MAX_FRAMES_IN_FLIGHT);
+    asio::thread_pool decodeWorkers(std::max(1u, boost::thread::hardware_concurrency()));
+    std::vector<std::unique_ptr<DecodePipeline>> pipelines;
+    for (size_t i = 0; i < connections.size(); i++) {
+        pipelines.push_back(std::make_unique<DecodePipeline>(decodeWorkers, [&simulation, i](DecodedFrame& decoded) {
+            applyFrame(simulation, decoded, i);
+        }, "region " + std::to_string(i), maxFramesInFlight));
+    }
+
+    boost::thread_group readerThreads;
+    for (size_t i = 0; i < connections.size(); i++) {
+        ConnectionManager* connection = connections[i].get();
+        DecodePipeline* pipeline = pipelines[i].get();
+        readerThreads.create_thread([&simulation, connection, pipeline, &recorder, i](){
+            readFromServer(simulation, *connection, *pipeline, recorder.get(), i);
+        });
+    }
+
+    simThread.join();
+
+    std::cout << "Close 4" << std::endl;
+    simulation.setIsRunning();
+    for (auto& connection : connections) {
+        connection->disconnect();
+    }
+
+    readerThreads.join_all();
+    decodeWorkers.join();
+    for (auto& pipeline : pipelines) {
+        pipeline->stop();
+    }
+    simUpdateThread.join();
+    explorerThread.join();
+
+    return 0;
+}
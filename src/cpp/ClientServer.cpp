@@ -17,6 +17,7 @@
 #include <boost/system/error_code.hpp>
 
 #include "ParticleSimulation.hpp"
+#include "ConnectionManager.hpp"
 
 using boost::asio::ip::tcp;
 namespace asio = boost::asio;
@@ -37,59 +38,122 @@ std::vector<char> prepareMessageForJavaUTF(const std::string& message) {
 }
 
 std::string decompressGzip(const std::vector<char>& compressedData) {
-    z_stream strm = {};
-    strm.zalloc = Z_NULL;
-    strm.zfree = Z_NULL;
-    strm.opaque = Z_NULL;
-    strm.avail_in = compressedData.size();
-    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressedData.data()));
-
-    if (inflateInit2(&strm, 16 + MAX_WBITS) != Z_OK) {
-        throw std::runtime_error("inflateInit2 failed");
+    return decodePayload(static_cast<uint8_t>(CodecID::Gzip), compressedData);
+}
+
+namespace {
+    // Bytes from the start of a frame up to its payload: type length, type, send time, sequence, codec id and payload length.
+    size_t frameHeaderSize(size_t typeLength, bool hasCodec) {
+        return 2 + typeLength + sizeof(uint64_t) * 2 + (hasCodec ? 1 : 0) + 4;
+    }
+
+    size_t frameTypeLength(const unsigned char* header) {
+        return (header[0] << 8) | header[1];
     }
 
-    int ret;
-    char outbuffer[4096];
-    std::string decompressedData;
-
-    do {
-        strm.avail_out = sizeof(outbuffer);
-        strm.next_out = reinterpret_cast<Bytef*>(outbuffer);
-        ret = inflate(&strm, Z_NO_FLUSH);
-        assert(ret != Z_STREAM_ERROR);  
-        switch (ret) {
-            case Z_NEED_DICT:
-                ret = Z_DATA_ERROR;     
-            case Z_DATA_ERROR:
-            case Z_MEM_ERROR:
-                inflateEnd(&strm);
-                throw std::runtime_error("inflate failed");
+    // Fills the frame's header fields from a complete header and returns the payload length.
+    size_t decodeFrameHeader(const unsigned char* header, bool hasCodec, ServerFrame& frame) {
+        size_t typeLength = frameTypeLength(header);
+        const unsigned char* field = header + 2;
+
+        frame.type.assign(reinterpret_cast<const char*>(field), typeLength);
+        frame.type.erase(std::remove(frame.type.begin(), frame.type.end(), '\0'), frame.type.end());
+        field += typeLength;
+
+        uint64_t sequence;
+        std::memcpy(&frame.serverTime, field, sizeof(frame.serverTime));
+        field += sizeof(frame.serverTime);
+        std::memcpy(&sequence, field, sizeof(sequence));
+        field += sizeof(sequence);
+        frame.sequence = ntohll(sequence);
+
+        frame.codec = static_cast<uint8_t>(CodecID::Gzip);
+        if (hasCodec) {
+            frame.codec = *field++;
         }
-        int have = sizeof(outbuffer) - strm.avail_out;
-        decompressedData.append(outbuffer, have);
-    } while (strm.avail_out == 0);
 
-    inflateEnd(&strm);
+        return (static_cast<size_t>(field[0]) << 24) |
+               (field[1] << 16) |
+               (field[2] << 8)  |
+               field[3];
+    }
+}
+
+bool readServerFrame(tcp::socket& socket, ServerFrame& frame, error_code& ec, bool hasCodec) {
+    std::vector<unsigned char> header(2);
+    asio::read(socket, asio::buffer(header), ec);
+    if (ec) {
+        return false;
+    }
+
+    header.resize(frameHeaderSize(frameTypeLength(header.data()), hasCodec));
+    asio::read(socket, asio::buffer(header.data() + 2, header.size() - 2), ec);
+    if (ec) {
+        return false;
+    }
+
+    frame.payload.resize(decodeFrameHeader(header.data(), hasCodec, frame));
+    asio::read(socket, asio::buffer(frame.payload), ec);
+
+    return !ec;
+}
+
+// Decodes one frame from already received bytes. Returns the number of bytes consumed, or 0 if incomplete.
+size_t parseServerFrame(const char* data, size_t size, ServerFrame& frame, bool hasCodec) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    if (size < 2) {
+        return 0;
+    }
+
+    size_t headerSize = frameHeaderSize(frameTypeLength(bytes), hasCodec);
+    if (size < headerSize) {
+        return 0;
+    }
+
+    size_t payloadLength = decodeFrameHeader(bytes, hasCodec, frame);
+    if (size < headerSize + payloadLength) {
+        return 0;
+    }
+
+    frame.payload.assign(data + headerSize, data + headerSize + payloadLength);
+
+    return headerSize + payloadLength;
+}
+
+// Looks for config.json two directories above the working directory, where the build tree places the executables.
+std::string clientConfigPath() {
+    return (fs::current_path().parent_path().parent_path() / "config.json").string();
+}
+
+// Lists the codecs this client can decode. Until the server answers with a Codec frame, frames stay gzip-only.
+std::string formatCodecOffer(const std::vector<std::string>& codecs) {
+    std::string message = "Codecs";
+    for (const auto& codec : codecs) {
+        message += " " + codec;
+    }
+    return message;
+}
 
-    return decompressedData;
+std::string formatExplorerMessage(double x, double y) {
+    return "ExplorerCoordinates " + std::to_string(x) + " " + std::to_string(y);
+}
+
+// Appends the view rectangle so the server limits what it streams to the explorer's area of interest.
+std::string formatExplorerMessage(double x, double y, const sf::FloatRect& view) {
+    if (view.width <= 0 || view.height <= 0) {
+        return formatExplorerMessage(x, y);
+    }
+    return formatExplorerMessage(x, y) + " " + std::to_string(view.left) + " " + std::to_string(view.top)
+           + " " + std::to_string(view.width) + " " + std::to_string(view.height);
 }
 
-void sendExplorerToServer(asio::ip::tcp::socket& socket, SimulationPanel& SimPanel) {
+bool sendExplorerToServer(ConnectionManager& connection, SimulationPanel& SimPanel) {
     std::shared_ptr<Explorer> explorer = SimPanel.getExplorer();
-    if (explorer) {
+    if (explorer && connection.isReady()) {
         //std::cout << "ExpExists " << std::endl;
-        double x_coords = explorer->getXCoord();
-        double y_coords = explorer->getYCoord();
-        std::string message = "ExplorerCoordinates " + std::to_string(x_coords) + " " + std::to_string(y_coords);
-        auto formattedMessage = prepareMessageForJavaUTF(message);
-        size_t bytesWritten = asio::write(socket, asio::buffer(formattedMessage));
-        if (bytesWritten == formattedMessage.size()) {
-            // std::cout << "Successfully wrote " << bytesWritten << " bytes to the socket." << std::endl;
-        } else {
-            std::cerr << "Error writing to socket. Expected " << formattedMessage.size()
-                      << " bytes but wrote " << bytesWritten << " bytes." << std::endl;
-        }
+        return connection.send(formatExplorerMessage(explorer->getXCoord(), explorer->getYCoord(), SimPanel.getViewRect()));
     }
+    return false;
 }
 
 uint64_t ntohll(uint64_t value) {
@@ -112,152 +176,3 @@ long long getTimeDifference(uint64_t javaTimeMillis) {
 
     return timeDifference;
 }
-
-int main() {
-    std::cout << "Current Path: " << fs::current_path() << std::endl;
-    
-    fs::path currentPath = fs::current_path();
-    fs::path configPath = currentPath.parent_path().parent_path() / "config.json";
-
-    std::ifstream configFile(configPath.string());
-    json configJson;
-
-    if (configFile.is_open()) {
-        configFile >> configJson;
-        configFile.close();
-    } else {
-        std::cerr << "Could not open config file: " << configPath.string() << " - " << std::strerror(errno) << std::endl;
-        return 1;
-    }
-
-    std::string server_ip = configJson.value("ip", "127.0.0.1"); 
-    std::string server_port = configJson.value("port", "1234");
-    std::cout << "Configured to connect to server at " << server_ip << ":" << server_port << std::endl;
-
-    asio::io_context io_context;
-    tcp::resolver resolver(io_context);
-    auto endpoints = resolver.resolve(server_ip, server_port);
-    tcp::socket socket(io_context);
-    boost::system::error_code ec;
-    connect(socket, endpoints, ec);
-
-    ParticleSimulation simulation;
-
-    if (ec) {
-        std::cerr << "Failed to connect to server: " << ec.message() << std::endl;
-        return 1;
-    }
-    std::cout << "Connected to server." << std::endl;
-
-    boost::thread simThread([&simulation](){
-        simulation.run();
-        std::cout << "Close 2" << std::endl;
-    });
-
-    boost::thread simUpdateThread([&simulation](){
-        simulation.updateSimulationLoop();
-        std::cout << "Close 1" << std::endl;
-    });
-
-
-    boost::thread explorerThread([&socket, &simulation](){
-        while (simulation.getIsRunning()) {
-            if (simulation.getSimulationPanel().getExplorer() != nullptr && simulation.getSimulationPanel().getExplorer()->getMove()){
-                sendExplorerToServer(socket, simulation.getSimulationPanel());
-                simulation.getSimulationPanel().getExplorer()->revertMove();
-            }
-            boost::this_thread::sleep(boost::posix_time::milliseconds(1000));
-        }
-        std::cout << "Close 3" << std::endl;
-    });
-
-    std::cout << "Starting to read from server." << std::endl;
-
-    try {
-        boost::system::error_code ec;
-        size_t len;
-        //socket.non_blocking(true, ec);
-
-        while (simulation.getIsRunning()) {
-            asio::streambuf buffer;
-            std::istream input_stream(&buffer);
-
-            boost::asio::socket_base::bytes_readable command(true);
-            socket.io_control(command);
-
-            len = socket.read_some(buffer.prepare(2), ec); 
-
-            if (ec == boost::asio::error::would_block) {
-                // std::cerr << "Nothing! " << std::endl;
-                
-            } else if (ec) {
-                std::cerr << "Read error: " << ec.message() << std::endl;
-                break;
-
-            } else {
-                buffer.commit(len); 
-
-                std::vector<unsigned char> lengthBytes(2);
-                input_stream.read(reinterpret_cast<char*>(lengthBytes.data()), 2);
-                unsigned int length = (lengthBytes[0] << 8) | lengthBytes[1]; 
-                std::string dataType;
-                dataType.resize(length);
-                len = asio::read(socket, buffer, asio::transfer_exactly(length));
-                input_stream.read(&dataType[0], length);
-                dataType.erase(std::remove(dataType.begin(), dataType.end(), '\0'), dataType.end());
-
-                std::cout << "Data Type: " << dataType << std::endl;
-
-                uint64_t serverTime;
-                asio::read(socket, asio::buffer(&serverTime, sizeof(serverTime)));
-                
-                std::cout << "Received server time: " << serverTime << std::endl;
-
-                long elapsedTime = getTimeDifference(serverTime);
-                std::cout << "Elapsed Time: " << elapsedTime << " milliseconds" << std::endl;
-
-                len = asio::read(socket, buffer, asio::transfer_exactly(4));
-                std::vector<unsigned char> jsonLengthBytes(4);
-                input_stream.read(reinterpret_cast<char*>(jsonLengthBytes.data()), 4);
-                unsigned int jsonLength = (jsonLengthBytes[0] << 24) |
-                                        (jsonLengthBytes[1] << 16) |
-                                        (jsonLengthBytes[2] << 8)  |
-                                        jsonLengthBytes[3];
-
-                std::vector<char> jsonData(jsonLength);
-                len = asio::read(socket, buffer, asio::transfer_exactly(jsonLength));
-                input_stream.read(jsonData.data(), jsonLength);
-
-                try {
-                    std::string decompressedJson = decompressGzip(jsonData);
-                    auto jsonParsed = json::parse(decompressedJson);
-                    std::cout << "JSON Data: " << jsonParsed.dump(4) << std::endl;
-                    
-                    if ("ID" == dataType){
-                        simulation.setID(jsonParsed);
-                    } else if ("Particles" == dataType){
-                        simulation.addParticle(jsonParsed, elapsedTime);
-                    } else if ("Explorers" == dataType){
-                        simulation.addOtherExplorer(jsonParsed);
-                    } else if ("Remove" == dataType){
-                        simulation.removeExplorer(jsonParsed);
-                    } 
-
-                } catch (const std::exception& e) {
-                    std::cerr << "Error handling JSON data: " << e.what() << std::endl;
-                }
-            } 
-        }
-    } catch (std::exception& e) {
-        std::cerr << "Exception: " << e.what() << std::endl;
-    } 
-
-    std::cout << "Close 4" << std::endl;
-    simulation.setIsRunning();
-
-    simUpdateThread.join();
-    simThread.join();
-    explorerThread.join();
-
-    return 0;
-}
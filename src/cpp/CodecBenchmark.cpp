@@ -0,0 +1,193 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+#include "PayloadCodec.hpp"
+
+namespace {
+    // Same defaults as PayloadCodec.java on the server.
+    const size_t DEFAULT_RAW_MAX_BYTES = 32;
+    const size_t DEFAULT_DICTIONARY_MAX_BYTES = 2048;
+
+    struct CodecResult {
+        std::string name;
+        size_t messages = 0;
+        size_t rawBytes = 0;
+        size_t encodedBytes = 0;
+        double decodeSeconds = 0;
+    };
+
+    // Mirrors PayloadCodec.choose on the server for a client that accepted every codec.
+    const PayloadCodec* choosePayloadCodec(size_t length, size_t rawMaxBytes, size_t dictionaryMaxBytes) {
+        if (length <= rawMaxBytes) {
+            return findPayloadCodec(static_cast<uint8_t>(CodecID::Raw));
+        }
+        if (length <= dictionaryMaxBytes) {
+            return findPayloadCodec(static_cast<uint8_t>(CodecID::Dictionary));
+        }
+        return findPayloadCodec(static_cast<uint8_t>(CodecID::LZ4));
+    }
+
+    size_t decodeAll(const std::vector<const PayloadCodec*>& codecs, const std::vector<std::vector<char>>& encoded,
+                     int iterations, double& seconds) {
+        size_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            for (size_t i = 0; i < encoded.size(); i++) {
+                checksum += codecs[i]->decode(encoded[i]).size();
+            }
+        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return checksum;
+    }
+
+    // Encodes every payload with the codec the chooser returns, then times decoding them all.
+    // Encoding uses the C zlib and lz4 libraries, not the server's Java encoders.
+    template <typename Chooser>
+    CodecResult measure(const std::string& name, const std::vector<std::string>& payloads, int iterations, Chooser choose) {
+        CodecResult result;
+        result.name = name;
+
+        std::vector<const PayloadCodec*> codecs;
+        std::vector<std::vector<char>> encoded;
+        for (const auto& payload : payloads) {
+            codecs.push_back(choose(payload));
+            encoded.push_back(codecs.back()->encode(payload));
+            result.rawBytes += payload.size();
+            result.encodedBytes += encoded.back().size();
+        }
+        result.messages = payloads.size();
+
+        size_t checksum = decodeAll(codecs, encoded, iterations, result.decodeSeconds);
+        if (checksum != result.rawBytes * iterations) {
+            throw std::runtime_error(name + " did not decode to the recorded payloads");
+        }
+        return result;
+    }
+
+    // The payloads exactly as the server encoded them, with the codec it chose for each.
+    CodecResult measureRecorded(const std::vector<RecordedPayload>& recorded, const std::vector<std::string>& payloads, int iterations) {
+        CodecResult result;
+        result.name = "server";
+
+        std::vector<const PayloadCodec*> codecs;
+        std::vector<std::vector<char>> encoded;
+        for (size_t i = 0; i < recorded.size(); i++) {
+            codecs.push_back(findPayloadCodec(recorded[i].codec));
+            encoded.push_back(recorded[i].payload);
+            result.rawBytes += payloads[i].size();
+            result.encodedBytes += encoded.back().size();
+        }
+        result.messages = recorded.size();
+
+        if (decodeAll(codecs, encoded, iterations, result.decodeSeconds) != result.rawBytes * iterations) {
+            throw std::runtime_error("server payloads did not decode to the recorded payloads");
+        }
+        return result;
+    }
+
+    void printResult(const CodecResult& result, int iterations) {
+        double ratio = result.encodedBytes > 0 ? static_cast<double>(result.rawBytes) / result.encodedBytes : 0;
+        double seconds = std::max(1e-9, result.decodeSeconds);
+        double decodedMB = static_cast<double>(result.rawBytes) * iterations / (1024.0 * 1024.0);
+        double perMessageMicros = result.messages > 0 ? seconds * 1e6 / (result.messages * iterations) : 0;
+
+        std::cout << std::setw(8) << result.name
+                  << std::setw(10) << result.messages
+                  << std::setw(12) << result.rawBytes
+                  << std::setw(12) << result.encodedBytes
+                  << std::setw(8) << ratio
+                  << std::setw(10) << decodedMB / seconds
+                  << std::setw(12) << perMessageMicros << std::endl;
+    }
+
+    void printTable(const std::string& title, const std::vector<RecordedPayload>& recorded, const std::vector<std::string>& payloads,
+                    int iterations, size_t rawMaxBytes, size_t dictionaryMaxBytes) {
+        std::cout << title << " (" << payloads.size() << " messages)" << std::endl;
+        if (payloads.empty()) {
+            return;
+        }
+        std::cout << "   codec  messages   raw_bytes   enc_bytes   ratio  dec_MB/s  us/message" << std::endl;
+        for (const PayloadCodec* codec : getPayloadCodecs()) {
+            printResult(measure(codec->getName(), payloads, iterations, [codec](const std::string&) { return codec; }), iterations);
+        }
+        printResult(measure("chosen", payloads, iterations, [rawMaxBytes, dictionaryMaxBytes](const std::string& payload) {
+            return choosePayloadCodec(payload.size(), rawMaxBytes, dictionaryMaxBytes);
+        }), iterations);
+        printResult(measureRecorded(recorded, payloads, iterations), iterations);
+        std::cout << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = 20;
+    size_t rawMaxBytes = DEFAULT_RAW_MAX_BYTES;
+    size_t dictionaryMaxBytes = DEFAULT_DICTIONARY_MAX_BYTES;
+
+    bool validArguments = argc % 2 == 0;
+    for (int i = 2; validArguments && i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--iterations") {
+            iterations = std::max(1, std::stoi(value));
+        } else if (option == "--raw-max") {
+            rawMaxBytes = std::stoul(value);
+        } else if (option == "--dict-max") {
+            dictionaryMaxBytes = std::stoul(value);
+        } else {
+            validArguments = false;
+        }
+    }
+
+    if (!validArguments) {
+        std::cerr << "Usage: CodecBenchmark RECORDING [--iterations N] [--raw-max BYTES] [--dict-max BYTES]" << std::endl;
+        return 1;
+    }
+
+    std::vector<RecordedPayload> recorded;
+    if (!readPayloadRecording(argv[1], recorded)) {
+        std::cerr << "Could not read payload recording " << argv[1] << std::endl;
+        return 1;
+    }
+
+    // Every codec is measured on the decoded JSON, whatever codec the payload was recorded with.
+    // The recorded bytes themselves are kept for the server row.
+    std::vector<std::string> all;
+    std::vector<std::string> small;
+    std::vector<std::string> large;
+    std::vector<RecordedPayload> allWire;
+    std::vector<RecordedPayload> smallWire;
+    std::vector<RecordedPayload> largeWire;
+    size_t failed = 0;
+    for (const auto& payload : recorded) {
+        try {
+            all.push_back(decodePayload(payload.codec, payload.payload));
+        } catch (const std::exception& e) {
+            failed++;
+            continue;
+        }
+        allWire.push_back(payload);
+        bool isSmall = all.back().size() <= dictionaryMaxBytes;
+        (isSmall ? small : large).push_back(all.back());
+        (isSmall ? smallWire : largeWire).push_back(payload);
+    }
+
+    std::cout << "Read " << recorded.size() << " payloads from " << argv[1];
+    if (failed > 0) {
+        std::cout << ", " << failed << " could not be decoded";
+    }
+    std::cout << ". Decoding each set " << iterations << " times." << std::endl;
+    std::cout << "Codec rows are encoded here with the C zlib and lz4 libraries. The server encodes LZ4 with its own"
+              << " Java matcher, so its ratio and decode speed are in the server row, measured on the recorded bytes." << std::endl << std::endl;
+
+    std::cout << std::fixed << std::setprecision(2);
+    printTable("All payloads", allWire, all, iterations, rawMaxBytes, dictionaryMaxBytes);
+    printTable("Payloads up to " + std::to_string(dictionaryMaxBytes) + " bytes", smallWire, small, iterations, rawMaxBytes, dictionaryMaxBytes);
+    printTable("Payloads over " + std::to_string(dictionaryMaxBytes) + " bytes", largeWire, large, iterations, rawMaxBytes, dictionaryMaxBytes);
+
+    return 0;
+}
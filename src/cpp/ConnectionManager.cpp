@@ -0,0 +1,162 @@
+#include "ConnectionManager.hpp"
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "ClientServer.hpp"
+#include "ParticleSimulation.hpp"
+
+using boost::asio::ip::tcp;
+namespace asio = boost::asio;
+using boost::system::error_code;
+using json = nlohmann::json;
+
+ConnectionManager::ConnectionManager(const std::string& ip, const std::string& port, int initialBackoffMs, int maxBackoffMs)
+    : socket(io_context), server_ip(ip), server_port(port),
+      initialBackoffMs(std::max(1, initialBackoffMs)), maxBackoffMs(std::max(initialBackoffMs, maxBackoffMs)) {
+}
+
+bool ConnectionManager::connectWithBackoff(const ParticleSimulation& simulation) {
+    int backoffMs = initialBackoffMs;
+
+    while (simulation.getIsRunning()) {
+        error_code ec;
+        {
+            std::lock_guard<std::mutex> lock(socketMutex);
+            tcp::resolver resolver(io_context);
+            auto endpoints = resolver.resolve(server_ip, server_port, ec);
+            if (!ec) {
+                socket = tcp::socket(io_context);
+                asio::connect(socket, endpoints, ec);
+            }
+        }
+
+        if (!ec) {
+            // Written before the connection counts as connected, so no explorer update can reach the server
+            // ahead of the identity and be registered under the connection's temporary ID.
+            codecFraming = false;
+            if (!offeredCodecs.empty()) {
+                write(formatCodecOffer(offeredCodecs));
+            }
+            if (identity >= 0) {
+                write("Identity " + std::to_string(identity));
+            }
+
+            // A connection that will resume must not carry explorer updates before the resume either.
+            awaitingSession = sessionStarted;
+            connected = true;
+            std::cout << "Connected to server." << std::endl;
+            return true;
+        }
+
+        std::cerr << "Failed to connect to server: " << ec.message()
+                  << ". Retrying in " << backoffMs << " milliseconds." << std::endl;
+        boost::this_thread::sleep(boost::posix_time::milliseconds(backoffMs));
+        backoffMs = std::min(backoffMs * 2, maxBackoffMs);
+    }
+
+    return false;
+}
+
+void ConnectionManager::disconnect() {
+    std::lock_guard<std::mutex> lock(socketMutex);
+    connected = false;
+    error_code ec;
+    socket.shutdown(tcp::socket::shutdown_both, ec);
+    socket.close(ec);
+}
+
+bool ConnectionManager::readFrame(ServerFrame& frame, error_code& ec) {
+    if (!connected) {
+        ec = asio::error::not_connected;
+        return false;
+    }
+    return readServerFrame(socket, frame, ec, codecFraming);
+}
+
+bool ConnectionManager::send(const std::string& message) {
+    if (!connected) {
+        return false;
+    }
+    return write(message);
+}
+
+bool ConnectionManager::write(const std::string& message) {
+    auto formattedMessage = prepareMessageForJavaUTF(message);
+    std::lock_guard<std::mutex> lock(socketMutex);
+    error_code ec;
+    size_t bytesWritten = asio::write(socket, asio::buffer(formattedMessage), ec);
+    if (ec || bytesWritten != formattedMessage.size()) {
+        std::cerr << "Error writing to socket. Expected " << formattedMessage.size()
+                  << " bytes but wrote " << bytesWritten << " bytes." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ConnectionManager::setCodecs(const std::vector<std::string>& codecs) {
+    offeredCodecs = codecs;
+}
+
+// Called for the server's Codec frame. Every frame after it carries its codec id.
+void ConnectionManager::acceptCodecs(const json& jsonData) {
+    codecFraming = true;
+    std::cout << "Payload codecs accepted:";
+    for (const auto& codec : jsonData.value("codecs", json::array())) {
+        std::cout << " " << codec.get<std::string>();
+    }
+    std::cout << std::endl;
+}
+
+// Must be called before connecting.
+void ConnectionManager::setIdentity(int identity) {
+    this->identity = identity;
+}
+
+void ConnectionManager::setClientID(int clientID) {
+    this->clientID = clientID;
+}
+
+void ConnectionManager::requestResume() {
+    // Frames that arrive before the server answers belong to the fresh connection and are dropped.
+    awaitingSession = true;
+    send("Resume " + std::to_string(clientID) + " " + std::to_string(lastSequence.load()));
+}
+
+bool ConnectionManager::shouldApply(const ServerFrame& frame) {
+    if (frame.type == "Session" || frame.type == "Codec") {
+        return true;
+    }
+    if (awaitingSession || frame.sequence <= lastSequence) {
+        return false;
+    }
+    lastSequence = frame.sequence;
+    sessionStarted = true;
+    return true;
+}
+
+bool ConnectionManager::applySession(const json& jsonData) {
+    awaitingSession = false;
+    bool resumed = jsonData.value("resumed", false);
+    clientID = jsonData.value("clientID", clientID);
+    if (!resumed) {
+        lastSequence = 0;
+    }
+    std::cout << (resumed ? "Session resumed after sequence " : "Session restarted, last sequence ")
+              << lastSequence << std::endl;
+    return resumed;
+}
+
+// Connected and not waiting for the answer to a resume.
+bool ConnectionManager::isReady() const {
+    return connected.load() && !awaitingSession.load();
+}
+
+bool ConnectionManager::hasSession() const {
+    return sessionStarted;
+}
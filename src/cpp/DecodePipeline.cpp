@@ -0,0 +1,242 @@
+#include "DecodePipeline.hpp"
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/thread.hpp>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "ClientServer.hpp"
+#include "PayloadCodec.hpp"
+#include "SimulationPanel.hpp"
+
+namespace asio = boost::asio;
+using json = nlohmann::json;
+
+namespace {
+    // Particle arrays longer than this are turned into particles by several workers.
+    const size_t PARTICLE_CHUNK_SIZE = 20000;
+    const long REPORT_INTERVAL_MS = 5000;
+
+    double millisBetween(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+}
+
+DecodePipeline::DecodePipeline(asio::thread_pool& workers, ApplyFunction apply, const std::string& name, size_t maxInFlight)
+    : workers(workers), apply(std::move(apply)), name(name), maxInFlight(std::max<size_t>(1, maxInFlight)), decoding(0) {
+    applyThread = boost::thread([this]() { applyLoop(); });
+    reportThread = boost::thread([this]() { reportLoop(); });
+}
+
+DecodePipeline::~DecodePipeline() {
+    stop();
+}
+
+// Waits for room when too many frames are in flight, so a slow apply stage holds back the
+// socket reader instead of letting decoded frames pile up. False once the pipeline is stopping.
+bool DecodePipeline::reserveOrdinal(uint64_t& ordinal) {
+    std::unique_lock<std::mutex> lock(mutex);
+    spaceCondition.wait(lock, [this]() {
+        return stopping || nextOrdinal - nextToApply < maxInFlight;
+    });
+    if (stopping) {
+        return false;
+    }
+    ordinal = nextOrdinal++;
+    return true;
+}
+
+void DecodePipeline::submit(const ServerFrame& frame, long elapsedTime) {
+    auto decoded = std::make_shared<DecodedFrame>();
+    decoded->type = frame.type;
+    decoded->sequence = frame.sequence;
+    decoded->elapsedTime = elapsedTime;
+    decoded->receivedAt = std::chrono::steady_clock::now();
+    if (!reserveOrdinal(decoded->ordinal)) {
+        return;
+    }
+    decoding++;
+
+    asio::post(workers, [this, decoded, codec = frame.codec, payload = frame.payload]() mutable {
+        decode(decoded, codec, std::move(payload));
+    });
+}
+
+// For frames the reader already had to decode itself; they keep their place in the apply order.
+void DecodePipeline::submitDecoded(const std::string& type, const json& data) {
+    auto decoded = std::make_shared<DecodedFrame>();
+    decoded->type = type;
+    decoded->data = data;
+    decoded->receivedAt = std::chrono::steady_clock::now();
+    if (!reserveOrdinal(decoded->ordinal)) {
+        return;
+    }
+    decoding++;
+    complete(decoded);
+}
+
+void DecodePipeline::decode(const std::shared_ptr<DecodedFrame>& decoded, uint8_t codec, std::vector<char> payload) {
+    // The whole payload is parsed in one call; only turning a large array into particles is split across workers.
+    try {
+        decoded->data = json::parse(decodePayload(codec, payload));
+    } catch (const std::exception& e) {
+        decoded->failed = true;
+        decoded->error = e.what();
+        complete(decoded);
+        return;
+    }
+
+    if (decoded->type != "Particles") {
+        complete(decoded);
+        return;
+    }
+
+    try {
+        if (!decoded->data.is_array()) {
+            decoded->particles.push_back(SimulationPanel::decodeExtrapolatedParticle(decoded->data, decoded->elapsedTime));
+            complete(decoded);
+            return;
+        }
+
+        size_t count = decoded->data.size();
+        decoded->particles.resize(count);
+        if (count <= PARTICLE_CHUNK_SIZE) {
+            for (size_t i = 0; i < count; i++) {
+                decoded->particles[i] = SimulationPanel::decodeParticle(decoded->data[i]);
+            }
+            complete(decoded);
+            return;
+        }
+    } catch (const std::exception& e) {
+        decoded->failed = true;
+        decoded->error = e.what();
+        complete(decoded);
+        return;
+    }
+
+    size_t count = decoded->data.size();
+    size_t chunks = (count + PARTICLE_CHUNK_SIZE - 1) / PARTICLE_CHUNK_SIZE;
+    auto remaining = std::make_shared<std::atomic<size_t>>(chunks);
+    auto failure = std::make_shared<std::mutex>();
+
+    for (size_t c = 0; c < chunks; c++) {
+        size_t begin = c * PARTICLE_CHUNK_SIZE;
+        size_t end = std::min(count, begin + PARTICLE_CHUNK_SIZE);
+        asio::post(workers, [this, decoded, remaining, failure, begin, end]() {
+            try {
+                // Chunks only read the parsed array, so they can share it.
+                const json& array = decoded->data;
+                for (size_t i = begin; i < end; i++) {
+                    decoded->particles[i] = SimulationPanel::decodeParticle(array[i]);
+                }
+            } catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(*failure);
+                decoded->failed = true;
+                decoded->error = e.what();
+            }
+            if (--(*remaining) == 0) {
+                complete(decoded);
+            }
+        });
+    }
+}
+
+void DecodePipeline::complete(const std::shared_ptr<DecodedFrame>& decoded) {
+    decoded->decodedAt = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        completed[decoded->ordinal] = decoded;
+    }
+    decoding--;
+    readyCondition.notify_one();
+}
+
+void DecodePipeline::applyLoop() {
+    while (true) {
+        std::shared_ptr<DecodedFrame> decoded;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            readyCondition.wait(lock, [this]() {
+                return stopping || completed.count(nextToApply) > 0;
+            });
+            if (stopping) {
+                return;
+            }
+            auto it = completed.find(nextToApply);
+            decoded = it->second;
+            completed.erase(it);
+            nextToApply++;
+        }
+        spaceCondition.notify_one();
+
+        auto applyStart = std::chrono::steady_clock::now();
+        if (decoded->failed) {
+            std::cerr << "Error handling JSON data: " << decoded->error << std::endl;
+        } else {
+            try {
+                apply(*decoded);
+            } catch (const std::exception& e) {
+                std::cerr << "Error applying " << decoded->type << " frame: " << e.what() << std::endl;
+            }
+        }
+        recordApplied(*decoded, applyStart);
+    }
+}
+
+void DecodePipeline::recordApplied(const DecodedFrame& decoded, std::chrono::steady_clock::time_point applyStart) {
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    decodeMillisTotal += millisBetween(decoded.receivedAt, decoded.decodedAt);
+    waitMillisTotal += millisBetween(decoded.decodedAt, applyStart);
+    applyMillisTotal += millisBetween(applyStart, now);
+    intervalFrames++;
+    framesApplied++;
+}
+
+// Runs on its own timer rather than after each apply, so queues that stop draining are still reported.
+void DecodePipeline::reportLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopCondition.wait_for(lock, std::chrono::milliseconds(REPORT_INTERVAL_MS), [this]() { return stopping; })) {
+        std::ostringstream report;
+        report << "Pipeline " << name << ": decode queue " << decoding.load() << ", apply queue " << completed.size();
+        if (intervalFrames == 0) {
+            report << ", no frames applied";
+        } else {
+            report << ", decode " << decodeMillisTotal / intervalFrames << " ms, wait " << waitMillisTotal / intervalFrames
+                   << " ms, apply " << applyMillisTotal / intervalFrames << " ms";
+        }
+        report << ", " << framesApplied << " frames";
+
+        decodeMillisTotal = waitMillisTotal = applyMillisTotal = 0;
+        intervalFrames = 0;
+
+        lock.unlock();
+        std::cout << report.str() << std::endl;
+        lock.lock();
+    }
+}
+
+// The worker pool must be joined first so no decode is left pointing at this pipeline.
+void DecodePipeline::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    readyCondition.notify_all();
+    spaceCondition.notify_all();
+    stopCondition.notify_all();
+    if (applyThread.joinable()) {
+        applyThread.join();
+    }
+    if (reportThread.joinable()) {
+        reportThread.join();
+    }
+}
@@ -0,0 +1,109 @@
+#include "DensityMap.hpp"
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <boost/thread.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <SFML/Graphics.hpp>
+
+#include "Particle.hpp"
+
+namespace {
+    const int WORLD_WIDTH = 1280;
+    const int WORLD_HEIGHT = 720;
+    // Below this many particles per worker, handing the work over costs more than the binning.
+    const size_t PARTICLES_PER_THREAD = 50000;
+}
+
+DensityMap::DensityMap(int cellSize)
+    : cellSize(std::max(1, cellSize)), workers(std::max(1u, boost::thread::hardware_concurrency())) {
+    columns = (WORLD_WIDTH + this->cellSize - 1) / this->cellSize;
+    rows = (WORLD_HEIGHT + this->cellSize - 1) / this->cellSize;
+    counts.resize(columns * rows);
+    pixels.resize(columns * rows * 4);
+
+    texture.create(columns, rows);
+    sprite.setTexture(texture, true);
+    sprite.setScale(this->cellSize, this->cellSize);
+    sprite.setPosition(0, 0);
+}
+
+void DensityMap::binRange(const std::vector<Particle>& particles, size_t begin, size_t end, std::vector<uint32_t>& grid,
+                          const sf::Vector2f& focus, float radius, std::vector<sf::Vector2f>& nearFocus) const {
+    for (size_t i = begin; i < end; i++) {
+        // Rows follow screen coordinates, the same flip SimulationPanel applies when drawing particles.
+        float x = static_cast<float>(particles[i].getXCoord());
+        float y = static_cast<float>(WORLD_HEIGHT - particles[i].getYCoord());
+        int column = std::clamp(static_cast<int>(x) / cellSize, 0, columns - 1);
+        int row = std::clamp(static_cast<int>(y) / cellSize, 0, rows - 1);
+        grid[row * columns + column]++;
+
+        float dx = x - focus.x;
+        float dy = y - focus.y;
+        if (radius > 0 && dx * dx + dy * dy <= radius * radius) {
+            nearFocus.emplace_back(x, y);
+        }
+    }
+}
+
+void DensityMap::clear() {
+    std::fill(counts.begin(), counts.end(), 0);
+}
+
+void DensityMap::accumulate(const std::vector<Particle>& particles, const sf::Vector2f& focus, float radius,
+                            std::vector<sf::Vector2f>& nearFocus) {
+    size_t threadCount = std::max<size_t>(1, std::min<size_t>(boost::thread::hardware_concurrency(),
+                                                               particles.size() / PARTICLES_PER_THREAD));
+
+    if (threadCount == 1) {
+        binRange(particles, 0, particles.size(), counts, focus, radius, nearFocus);
+        return;
+    }
+
+    std::vector<std::vector<uint32_t>> localCounts(threadCount, std::vector<uint32_t>(counts.size(), 0));
+    std::vector<std::vector<sf::Vector2f>> localNear(threadCount);
+    std::vector<std::future<void>> done;
+    size_t chunk = (particles.size() + threadCount - 1) / threadCount;
+
+    for (size_t t = 0; t < threadCount; t++) {
+        size_t begin = t * chunk;
+        size_t end = std::min(particles.size(), begin + chunk);
+        auto task = std::make_shared<std::packaged_task<void()>>([&, t, begin, end]() {
+            binRange(particles, begin, end, localCounts[t], focus, radius, localNear[t]);
+        });
+        done.push_back(task->get_future());
+        boost::asio::post(workers, [task]() { (*task)(); });
+    }
+    for (auto& finished : done) {
+        finished.get();
+    }
+
+    for (size_t t = 0; t < threadCount; t++) {
+        for (size_t i = 0; i < counts.size(); i++) {
+            counts[i] += localCounts[t][i];
+        }
+        nearFocus.insert(nearFocus.end(), localNear[t].begin(), localNear[t].end());
+    }
+}
+
+void DensityMap::upload() {
+    uint32_t maxCount = *std::max_element(counts.begin(), counts.end());
+    double scale = maxCount > 0 ? 255.0 / std::log1p(maxCount) : 0.0;
+
+    for (size_t i = 0; i < counts.size(); i++) {
+        pixels[i * 4] = 255;
+        pixels[i * 4 + 1] = 0;
+        pixels[i * 4 + 2] = 0;
+        pixels[i * 4 + 3] = static_cast<sf::Uint8>(std::log1p(counts[i]) * scale);
+    }
+
+    texture.update(pixels.data());
+}
+
+void DensityMap::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    target.draw(sprite, states);
+}
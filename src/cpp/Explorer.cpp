@@ -67,6 +67,10 @@ void Explorer::revertMove() {
     moved = false;
 }
 
+void Explorer::markMoved() {
+    moved = true;
+}
+
 bool Explorer::getMove() {
     return moved;
 }
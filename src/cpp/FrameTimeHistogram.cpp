@@ -0,0 +1,69 @@
+#include "FrameTimeHistogram.hpp"
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+
+FrameTimeHistogram::FrameTimeHistogram(double bucketMillis, double maxMillis)
+    : bucketMillis(bucketMillis), count(0) {
+    buckets.resize(static_cast<size_t>(std::ceil(maxMillis / bucketMillis)) + 1, 0);
+}
+
+void FrameTimeHistogram::record(double frameMillis) {
+    size_t index = static_cast<size_t>(std::max(0.0, frameMillis) / bucketMillis);
+    buckets[std::min(index, buckets.size() - 1)]++;
+    count++;
+}
+
+void FrameTimeHistogram::merge(const FrameTimeHistogram& other) {
+    size_t shared = std::min(buckets.size(), other.buckets.size());
+    for (size_t i = 0; i < shared; i++) {
+        buckets[i] += other.buckets[i];
+    }
+    for (size_t i = shared; i < other.buckets.size(); i++) {
+        buckets.back() += other.buckets[i];
+    }
+    count += other.count;
+}
+
+void FrameTimeHistogram::reset() {
+    std::fill(buckets.begin(), buckets.end(), 0);
+    count = 0;
+}
+
+uint64_t FrameTimeHistogram::getCount() const {
+    return count;
+}
+
+double FrameTimeHistogram::percentile(double p) const {
+    if (count == 0) {
+        return 0.0;
+    }
+
+    uint64_t target = static_cast<uint64_t>(std::ceil(p / 100.0 * count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= target) {
+            return (i + 1) * bucketMillis;
+        }
+    }
+    return buckets.size() * bucketMillis;
+}
+
+bool FrameTimeHistogram::exportCSV(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    out << "bucket_start_ms,bucket_end_ms,count\n";
+    for (size_t i = 0; i < buckets.size(); i++) {
+        if (buckets[i] > 0) {
+            out << i * bucketMillis << "," << (i + 1) * bucketMillis << "," << buckets[i] << "\n";
+        }
+    }
+    return true;
+}
@@ -0,0 +1,232 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <unordered_map>
+#include <atomic>
+#include <boost/thread.hpp>
+#include <SFML/Graphics.hpp>
+
+#include "Particle.hpp"
+#include "SimulationShard.hpp"
+#include "SpatialOrder.hpp"
+
+namespace {
+    const float WORLD_WIDTH = 1280;
+    const float WORLD_HEIGHT = 720;
+    const float PARTICLE_RADIUS = 5;
+
+    struct LayoutResult {
+        std::string name;
+        double updateMillis = 0;
+        double cullMillis = 0;
+        double drawMillis = 0;
+        double reorderMillis = 0;
+        double maxLockWaitMillis = 0;
+        int reorders = 0;
+        size_t visible = 0;
+    };
+
+    double millisSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // The same particles for every run, created in random order the way they arrive from the server.
+    std::vector<Particle> makeParticles(size_t count) {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> x(1, WORLD_WIDTH - 1);
+        std::uniform_real_distribution<double> y(1, WORLD_HEIGHT - 1);
+        std::uniform_real_distribution<double> velocity(10, 100);
+        std::uniform_real_distribution<double> angle(0, 360);
+
+        std::vector<Particle> particles;
+        particles.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            particles.emplace_back(x(rng), y(rng), velocity(rng), angle(rng), static_cast<int>(i));
+        }
+        return particles;
+    }
+
+    // A reorder must move whole particles: every ID still has to lead to the state it had before.
+    bool idsPreserved(SimulationShard& shard) {
+        std::unordered_map<int, std::pair<SimReal, SimReal>> before;
+        shard.withParticles([&before](const std::vector<Particle>& particles) {
+            for (const auto& particle : particles) {
+                before[particle.getID()] = { particle.getXCoord(), particle.getYCoord() };
+            }
+        });
+
+        shard.reorder();
+
+        bool preserved = true;
+        size_t seen = 0;
+        shard.withParticles([&](const std::vector<Particle>& particles) {
+            for (const auto& particle : particles) {
+                auto it = before.find(particle.getID());
+                preserved = preserved && it != before.end()
+                            && it->second == std::make_pair(particle.getXCoord(), particle.getYCoord());
+                seen++;
+            }
+        });
+        return preserved && seen == before.size();
+    }
+
+    LayoutResult run(const std::string& name, const std::vector<Particle>& initial,
+                     int ticks, int interval, SpaceFillingCurve curve, const sf::FloatRect& view) {
+        LayoutResult result;
+        result.name = name;
+
+        SimulationShard shard(0, sf::FloatRect(0, 0, WORLD_WIDTH, WORLD_HEIGHT));
+        shard.setReordering(0, curve);
+        for (const auto& particle : initial) {
+            shard.addParticle(particle);
+        }
+
+        if (interval > 0 && !idsPreserved(shard)) {
+            std::cerr << name << ": reordering lost or changed particles" << std::endl;
+            result.reorders = -1;
+            return result;
+        }
+
+        std::vector<Particle> leaving;
+        std::vector<sf::Vector2f> visible;
+        sf::VertexArray vertices(sf::Quads);
+
+        // Stands in for the render thread, which takes the shard lock every frame.
+        std::atomic<bool> stepping(true);
+        boost::thread renderer([&shard, &stepping, &result]() {
+            while (stepping) {
+                auto start = std::chrono::steady_clock::now();
+                double waited = 0;
+                shard.withParticles([&waited, start](const std::vector<Particle>&) {
+                    waited = millisSince(start);
+                });
+                result.maxLockWaitMillis = std::max(result.maxLockWaitMillis, waited);
+                boost::this_thread::sleep(boost::posix_time::milliseconds(5));
+            }
+        });
+
+        for (int tick = 1; tick <= ticks; tick++) {
+            auto start = std::chrono::steady_clock::now();
+            leaving.clear();
+            shard.update(0.1, leaving);
+            // Particles bouncing off the world edge can step outside it for a tick; keep them in the run.
+            for (const auto& particle : leaving) {
+                shard.handOff(particle);
+            }
+            result.updateMillis += millisSince(start);
+
+            if (interval > 0 && tick % interval == 0) {
+                start = std::chrono::steady_clock::now();
+                shard.reorder();
+                result.reorderMillis += millisSince(start);
+                result.reorders++;
+            }
+
+            start = std::chrono::steady_clock::now();
+            visible.clear();
+            shard.withParticles([&visible, &view](const std::vector<Particle>& particles) {
+                for (const auto& particle : particles) {
+                    sf::Vector2f position(static_cast<float>(particle.getXCoord()), static_cast<float>(particle.getYCoord()));
+                    if (view.contains(position.x, position.y)) {
+                        visible.push_back(position);
+                    }
+                }
+            });
+            result.cullMillis += millisSince(start);
+            result.visible = visible.size();
+
+            // One batched quad per particle, the vertex work a single draw call for the view would need.
+            start = std::chrono::steady_clock::now();
+            vertices.clear();
+            for (const auto& position : visible) {
+                float left = position.x - PARTICLE_RADIUS;
+                float top = WORLD_HEIGHT - position.y - PARTICLE_RADIUS;
+                vertices.append(sf::Vertex(sf::Vector2f(left, top), sf::Color::Red));
+                vertices.append(sf::Vertex(sf::Vector2f(left + 2 * PARTICLE_RADIUS, top), sf::Color::Red));
+                vertices.append(sf::Vertex(sf::Vector2f(left + 2 * PARTICLE_RADIUS, top + 2 * PARTICLE_RADIUS), sf::Color::Red));
+                vertices.append(sf::Vertex(sf::Vector2f(left, top + 2 * PARTICLE_RADIUS), sf::Color::Red));
+            }
+            result.drawMillis += millisSince(start);
+        }
+
+        stepping = false;
+        renderer.join();
+
+        result.updateMillis /= ticks;
+        result.cullMillis /= ticks;
+        result.drawMillis /= ticks;
+        if (result.reorders > 0) {
+            result.reorderMillis /= result.reorders;
+        }
+        return result;
+    }
+
+    void printResult(const LayoutResult& result) {
+        std::cout << std::setw(10) << result.name
+                  << std::setw(11) << result.updateMillis
+                  << std::setw(9) << result.cullMillis
+                  << std::setw(9) << result.drawMillis
+                  << std::setw(12) << result.reorderMillis
+                  << std::setw(13) << result.maxLockWaitMillis
+                  << std::setw(10) << result.reorders
+                  << std::setw(9) << result.visible << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t particleCount = 200000;
+    int ticks = 200;
+    int interval = 50;
+    float viewFraction = 0.25f;
+
+    bool validArguments = argc % 2 == 1;
+    for (int i = 1; validArguments && i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--particles") {
+            particleCount = std::stoul(value);
+        } else if (option == "--ticks") {
+            ticks = std::max(1, std::stoi(value));
+        } else if (option == "--interval") {
+            interval = std::max(1, std::stoi(value));
+        } else if (option == "--view") {
+            viewFraction = std::clamp(std::stof(value), 0.01f, 1.0f);
+        } else {
+            validArguments = false;
+        }
+    }
+
+    if (!validArguments) {
+        std::cerr << "Usage: LayoutBenchmark [--particles N] [--ticks N] [--interval TICKS] [--view FRACTION]" << std::endl;
+        return 1;
+    }
+
+    // A view the size of a zoomed-in window, centred on the world.
+    float viewWidth = WORLD_WIDTH * viewFraction;
+    float viewHeight = WORLD_HEIGHT * viewFraction;
+    sf::FloatRect view((WORLD_WIDTH - viewWidth) / 2, (WORLD_HEIGHT - viewHeight) / 2, viewWidth, viewHeight);
+
+    std::cout << "Stepping " << particleCount << " particles for " << ticks << " ticks, reordering every "
+              << interval << " ticks, view covering " << viewFraction * 100 << "% of each axis." << std::endl;
+
+    auto initial = makeParticles(particleCount);
+    std::vector<LayoutResult> results = {
+        run("arrival", initial, ticks, 0, SpaceFillingCurve::Morton, view),
+        run("morton", initial, ticks, interval, SpaceFillingCurve::Morton, view),
+        run("hilbert", initial, ticks, interval, SpaceFillingCurve::Hilbert, view)
+    };
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "    layout  update_ms  cull_ms  draw_ms  reorder_ms  max_wait_ms  reorders  visible" << std::endl;
+    bool preserved = true;
+    for (const auto& result : results) {
+        printResult(result);
+        preserved = preserved && result.reorders >= 0;
+    }
+
+    return preserved ? 0 : 1;
+}
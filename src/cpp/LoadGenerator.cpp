@@ -0,0 +1,341 @@
+#include "LoadGenerator.hpp"
+
+#include <boost/asio.hpp>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "ClientServer.hpp"
+
+using boost::asio::ip::tcp;
+namespace asio = boost::asio;
+using boost::system::error_code;
+using json = nlohmann::json;
+
+namespace {
+    const double MIN_X = 6;
+    const double MAX_X = 1256;
+    const double MIN_Y = 6;
+    const double MAX_Y = 697;
+    const double STEP = 5;
+    const double CIRCLE_RADIUS = 100;
+
+    long long percentile(std::vector<long long> values, double p) {
+        if (values.empty()) {
+            return 0;
+        }
+        size_t index = static_cast<size_t>(std::ceil(p / 100.0 * values.size())) - 1;
+        index = std::min(index, values.size() - 1);
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    // User plus kernel time of the whole process. std::clock measures wall time on Windows.
+    double processCpuSeconds() {
+#ifdef _WIN32
+        FILETIME creationTime, exitTime, kernelTime, userTime;
+        if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+            return 0;
+        }
+        auto toSeconds = [](const FILETIME& time) {
+            ULARGE_INTEGER value;
+            value.LowPart = time.dwLowDateTime;
+            value.HighPart = time.dwHighDateTime;
+            return value.QuadPart / 1e7;
+        };
+        return toSeconds(kernelTime) + toSeconds(userTime);
+#else
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+        return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+#endif
+    }
+
+    bool parsePattern(const std::string& name, MovePattern& pattern) {
+        if (name == "idle") {
+            pattern = MovePattern::Idle;
+        } else if (name == "line") {
+            pattern = MovePattern::Line;
+        } else if (name == "circle") {
+            pattern = MovePattern::Circle;
+        } else if (name == "random") {
+            pattern = MovePattern::Random;
+        } else {
+            return false;
+        }
+        return true;
+    }
+}
+
+SimulatedClient::SimulatedClient(asio::io_context& io_context, int index, MovePattern pattern, int moveIntervalMs)
+    : socket(io_context), moveTimer(io_context), readBuffer(64 * 1024),
+      index(index), pattern(pattern), moveIntervalMs(moveIntervalMs), rng(index) {
+    std::uniform_real_distribution<double> xDist(MIN_X + CIRCLE_RADIUS, MAX_X - CIRCLE_RADIUS);
+    std::uniform_real_distribution<double> yDist(MIN_Y + CIRCLE_RADIUS, MAX_Y - CIRCLE_RADIUS);
+    originX = x_coord = xDist(rng);
+    originY = y_coord = yDist(rng);
+}
+
+void SimulatedClient::start(const tcp::resolver::results_type& endpoints) {
+    auto self = shared_from_this();
+    asio::async_connect(socket, endpoints, [self](const error_code& ec, const tcp::endpoint&) {
+        if (ec) {
+            std::cerr << "Client " << self->index << " failed to connect: " << ec.message() << std::endl;
+            return;
+        }
+        self->connected = true;
+        self->readMore();
+        self->sendMove();
+        self->scheduleMove();
+    });
+}
+
+void SimulatedClient::stop() {
+    error_code ec;
+    moveTimer.cancel();
+    socket.shutdown(tcp::socket::shutdown_both, ec);
+    socket.close(ec);
+}
+
+void SimulatedClient::readMore() {
+    auto self = shared_from_this();
+    socket.async_read_some(asio::buffer(readBuffer), [self](const error_code& ec, size_t length) {
+        if (ec) {
+            if (self->connected && ec != asio::error::operation_aborted) {
+                std::cerr << "Client " << self->index << " read error: " << ec.message() << std::endl;
+            }
+            self->connected = false;
+            return;
+        }
+        self->stats.bytes += length;
+        self->pending.insert(self->pending.end(), self->readBuffer.begin(), self->readBuffer.begin() + length);
+        self->consumeFrames();
+        self->readMore();
+    });
+}
+
+void SimulatedClient::consumeFrames() {
+    ServerFrame frame;
+    size_t offset = 0;
+    size_t consumed;
+
+    while ((consumed = parseServerFrame(pending.data() + offset, pending.size() - offset, frame)) > 0) {
+        offset += consumed;
+        stats.frames++;
+        if (frame.type != "Session") {
+            stats.latencies.push_back(getTimeDifference(frame.serverTime));
+        }
+
+        auto decodeStart = std::chrono::steady_clock::now();
+        try {
+            json::parse(decompressGzip(frame.payload));
+        } catch (const std::exception& e) {
+            stats.decodeErrors++;
+        }
+        stats.decodeMillis += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decodeStart).count();
+    }
+
+    pending.erase(pending.begin(), pending.begin() + offset);
+}
+
+void SimulatedClient::scheduleMove() {
+    if (pattern == MovePattern::Idle) {
+        return;
+    }
+    auto self = shared_from_this();
+    moveTimer.expires_after(std::chrono::milliseconds(moveIntervalMs));
+    moveTimer.async_wait([self](const error_code& ec) {
+        if (ec || !self->connected) {
+            return;
+        }
+        self->advancePattern();
+        self->sendMove();
+        self->scheduleMove();
+    });
+}
+
+void SimulatedClient::advancePattern() {
+    step++;
+    switch (pattern) {
+        case MovePattern::Line:
+            if (x_coord + direction * STEP < MIN_X || x_coord + direction * STEP > MAX_X) {
+                direction = -direction;
+            }
+            x_coord += direction * STEP;
+            break;
+        case MovePattern::Circle: {
+            double angle = step * STEP / CIRCLE_RADIUS;
+            x_coord = originX + CIRCLE_RADIUS * std::cos(angle);
+            y_coord = originY + CIRCLE_RADIUS * std::sin(angle);
+            break;
+        }
+        case MovePattern::Random: {
+            std::uniform_int_distribution<int> dir(0, 3);
+            int d = dir(rng);
+            x_coord = std::clamp(x_coord + (d == 0 ? STEP : d == 1 ? -STEP : 0), MIN_X, MAX_X);
+            y_coord = std::clamp(y_coord + (d == 2 ? STEP : d == 3 ? -STEP : 0), MIN_Y, MAX_Y);
+            break;
+        }
+        case MovePattern::Idle:
+            break;
+    }
+}
+
+void SimulatedClient::sendMove() {
+    // Skip a tick rather than queue writes behind a slow socket.
+    if (writing) {
+        return;
+    }
+    writing = true;
+    outgoing = prepareMessageForJavaUTF(formatExplorerMessage(x_coord, y_coord));
+
+    auto self = shared_from_this();
+    asio::async_write(socket, asio::buffer(outgoing), [self](const error_code& ec, size_t) {
+        self->writing = false;
+        if (!ec) {
+            self->stats.movesSent++;
+        }
+    });
+}
+
+int SimulatedClient::getIndex() const {
+    return index;
+}
+
+bool SimulatedClient::isConnected() const {
+    return connected;
+}
+
+const ClientStats& SimulatedClient::getStats() const {
+    return stats;
+}
+
+int main(int argc, char* argv[]) {
+    std::string server_ip = "127.0.0.1";
+    std::string server_port = "1234";
+    int clientCount = 100;
+    int durationSeconds = 30;
+    int moveIntervalMs = 100;
+    MovePattern pattern = MovePattern::Random;
+
+    std::ifstream configFile(clientConfigPath());
+    if (configFile.is_open()) {
+        json configJson;
+        configFile >> configJson;
+        server_ip = configJson.value("ip", server_ip);
+        server_port = configJson.value("port", server_port);
+    }
+
+    bool validArguments = argc % 2 == 1;
+    for (int i = 1; validArguments && i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--clients") {
+            clientCount = std::stoi(value);
+        } else if (option == "--duration") {
+            durationSeconds = std::stoi(value);
+        } else if (option == "--interval") {
+            moveIntervalMs = std::max(1, std::stoi(value));
+        } else if (option == "--pattern") {
+            validArguments = parsePattern(value, pattern);
+        } else if (option == "--ip") {
+            server_ip = value;
+        } else if (option == "--port") {
+            server_port = value;
+        } else {
+            validArguments = false;
+        }
+    }
+
+    if (!validArguments) {
+        std::cerr << "Usage: LoadGenerator [--clients N] [--duration SECONDS] [--interval MS]"
+                  << " [--pattern idle|line|circle|random] [--ip IP] [--port PORT]" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Starting " << clientCount << " clients against " << server_ip << ":" << server_port
+              << " for " << durationSeconds << " seconds." << std::endl;
+
+    asio::io_context io_context;
+    tcp::resolver resolver(io_context);
+    error_code ec;
+    auto endpoints = resolver.resolve(server_ip, server_port, ec);
+    if (ec) {
+        std::cerr << "Failed to resolve server: " << ec.message() << std::endl;
+        return 1;
+    }
+
+    std::vector<std::shared_ptr<SimulatedClient>> clients;
+    clients.reserve(clientCount);
+    for (int i = 0; i < clientCount; i++) {
+        clients.push_back(std::make_shared<SimulatedClient>(io_context, i, pattern, moveIntervalMs));
+        clients.back()->start(endpoints);
+    }
+
+    asio::steady_timer deadline(io_context, std::chrono::seconds(durationSeconds));
+    deadline.async_wait([&clients](const error_code&) {
+        for (auto& client : clients) {
+            client->stop();
+        }
+    });
+
+    double cpuStart = processCpuSeconds();
+    auto wallStart = std::chrono::steady_clock::now();
+    io_context.run();
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double cpuSeconds = std::max(1e-9, processCpuSeconds() - cpuStart);
+
+    std::vector<long long> allLatencies;
+    uint64_t totalFrames = 0;
+    uint64_t totalBytes = 0;
+    double totalDecodeMillis = 0;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "client  frames  frames/s    KB/s  lat_p50  lat_p95  lat_p99  lat_max  decode_ms  errors" << std::endl;
+    for (const auto& client : clients) {
+        const ClientStats& stats = client->getStats();
+        long long maxLatency = stats.latencies.empty() ? 0 : *std::max_element(stats.latencies.begin(), stats.latencies.end());
+        std::cout << std::setw(6) << client->getIndex()
+                  << std::setw(8) << stats.frames
+                  << std::setw(10) << stats.frames / wallSeconds
+                  << std::setw(8) << stats.bytes / 1024.0 / wallSeconds
+                  << std::setw(9) << percentile(stats.latencies, 50)
+                  << std::setw(9) << percentile(stats.latencies, 95)
+                  << std::setw(9) << percentile(stats.latencies, 99)
+                  << std::setw(9) << maxLatency
+                  << std::setw(11) << stats.decodeMillis
+                  << std::setw(8) << stats.decodeErrors << std::endl;
+
+        allLatencies.insert(allLatencies.end(), stats.latencies.begin(), stats.latencies.end());
+        totalFrames += stats.frames;
+        totalBytes += stats.bytes;
+        totalDecodeMillis += stats.decodeMillis;
+    }
+
+    std::cout << "Total: " << totalFrames << " frames, " << totalBytes / 1024.0 << " KB in " << wallSeconds << " s ("
+              << totalFrames / wallSeconds << " frames/s, " << totalBytes / 1024.0 / wallSeconds << " KB/s)" << std::endl;
+    std::cout << "Latency ms: p50 " << percentile(allLatencies, 50) << ", p95 " << percentile(allLatencies, 95)
+              << ", p99 " << percentile(allLatencies, 99) << std::endl;
+    std::cout << "Decode CPU: " << totalDecodeMillis << " ms (" << (totalDecodeMillis / 1000.0) / cpuSeconds * 100.0
+              << "% of " << cpuSeconds << " s process CPU)" << std::endl;
+
+    return 0;
+}
@@ -3,19 +3,22 @@
 #include <iostream>
 #include <cmath>
 #include <iomanip>
-#include <SFML/Graphics.hpp>
 #include <corecrt_math_defines.h>
 
-Particle::Particle(double x, double y, double velocity, double angle) 
-    : x_coord(x), y_coord(y), velocity(velocity), angle(angle) {
-    shape.setRadius(5); 
-    shape.setFillColor(sf::Color::Red);
-    shape.setPosition(x_coord - 5, 720 - y_coord - 5); 
+template <typename Real>
+BasicParticle<Real>::BasicParticle()
+    : BasicParticle(0, 0, 0, 0) {
 }
 
-void Particle::updatePosition(double time) {
-    double x2 = x_coord + getVelocityX() * time;
-    double y2 = y_coord + getVelocityY() * time;
+template <typename Real>
+BasicParticle<Real>::BasicParticle(Real x, Real y, Real velocity, Real angle, int id) 
+    : id(id), origin(0), x_coord(x), y_coord(y), velocity(velocity), angle(angle) {
+}
+
+template <typename Real>
+void BasicParticle<Real>::updatePosition(Real time) {
+    Real x2 = x_coord + getVelocityX() * time;
+    Real y2 = y_coord + getVelocityY() * time;
     if (x2 <= 0 || x2 >= 1280) {
         angle = 180 - angle; 
     }
@@ -24,36 +27,55 @@ void Particle::updatePosition(double time) {
     }
     x_coord += getVelocityX() * time;
     y_coord += getVelocityY() * time;
-    shape.setPosition(x_coord - 5, 720 - y_coord - 5);
 }
 
-double Particle::getXCoord() const {
+template <typename Real>
+int BasicParticle<Real>::getID() const {
+    return id;
+}
+
+template <typename Real>
+void BasicParticle<Real>::setOrigin(int origin) {
+    this->origin = origin;
+}
+
+template <typename Real>
+int BasicParticle<Real>::getOrigin() const {
+    return origin;
+}
+
+template <typename Real>
+Real BasicParticle<Real>::getXCoord() const {
     return x_coord;
 }
 
-double Particle::getYCoord() const {
+template <typename Real>
+Real BasicParticle<Real>::getYCoord() const {
     return y_coord;
 }
 
-double Particle::getAngle() const {
+template <typename Real>
+Real BasicParticle<Real>::getAngle() const {
     return angle;
 }
 
-double Particle::getVelocity() const {
+template <typename Real>
+Real BasicParticle<Real>::getVelocity() const {
     return velocity;
 }
 
 
-double Particle::getVelocityX() const {
-    double result = velocity * cos(angle * M_PI / 180.0);
-    return std::round(result * 10000.0) / 10000.0; 
+template <typename Real>
+Real BasicParticle<Real>::getVelocityX() const {
+    Real result = velocity * std::cos(angle * static_cast<Real>(M_PI) / 180);
+    return std::round(result * 10000) / 10000; 
 }
 
-double Particle::getVelocityY() const {
-    double result = velocity * sin(angle * M_PI / 180.0);
-    return std::round(result * 10000.0) / 10000.0;
+template <typename Real>
+Real BasicParticle<Real>::getVelocityY() const {
+    Real result = velocity * std::sin(angle * static_cast<Real>(M_PI) / 180);
+    return std::round(result * 10000) / 10000;
 }
 
-void Particle::draw(sf::RenderTarget& target, sf::RenderStates states) const {
-    target.draw(shape, states);
-}
+template class BasicParticle<float>;
+template class BasicParticle<double>;
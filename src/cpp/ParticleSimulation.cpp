@@ -5,15 +5,27 @@ ParticleSimulation::ParticleSimulation() : simulationPanel() {
 }
 
 void ParticleSimulation::updateSimulationLoop() {
-    while (isRunning) {
-        simulationPanel.updateSimulation();
-        
-        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    boost::thread_group shardThreads;
+
+    for (size_t i = 0; i < simulationPanel.getShardCount(); i++) {
+        shardThreads.create_thread([this, i]() {
+            while (isRunning) {
+                simulationPanel.updateSimulation(i);
+                
+                boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+            }
+        });
     }
+
+    shardThreads.join_all();
 }
 
 void ParticleSimulation::run() {
     sf::RenderWindow window(sf::VideoMode(1280, 720), "Simulation Panel");
+    window.setVerticalSyncEnabled(vsync);
+    if (!vsync && targetFPS > 0) {
+        window.setFramerateLimit(targetFPS);
+    }
     window.clear(sf::Color::Black);
     float borderThickness = 500.0f;
     sf::RectangleShape borderRect;
@@ -30,6 +42,7 @@ void ParticleSimulation::run() {
     // Display the contents of the RenderWindow
     window.display();
     std::shared_ptr<Explorer> explorer = nullptr;
+    sf::Clock frameClock;
 
     while (window.isOpen() && isRunning) {
         sf::Event event;
@@ -48,6 +61,11 @@ void ParticleSimulation::run() {
                     std::cout << "Added explorer at: " << mousePos.x << ", " << mousePos.y << std::endl;
                 }
             }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::H) {
+                if (simulationPanel.exportFrameTimes("frame_times.csv")) {
+                    std::cout << "Frame time histogram written to frame_times.csv" << std::endl;
+                }
+            }
             else if (event.type == sf::Event::KeyPressed && explorer != nullptr) {
                 if (explorer){
                     if (event.key.code == sf::Keyboard::W) {
@@ -78,9 +96,24 @@ void ParticleSimulation::run() {
         window.draw(simulationPanel);
         window.draw(borderRect);
         window.display();
+
+        simulationPanel.recordFrame(frameClock.restart().asMicroseconds() / 1000.0);
     }
 }
 
+void ParticleSimulation::setRegions(const std::vector<sf::FloatRect>& regions) {
+    simulationPanel.setRegions(regions);
+}
+
+void ParticleSimulation::setParticleReordering(int intervalTicks, SpaceFillingCurve curve) {
+    simulationPanel.setParticleReordering(intervalTicks, curve);
+}
+
+void ParticleSimulation::setRenderPacing(int targetFPS, bool vsync) {
+    this->targetFPS = targetFPS;
+    this->vsync = vsync;
+}
+
 void ParticleSimulation::applyZoomAndCenter(sf::RenderWindow& window, double x, double y) {
     sf::Vector2u windowSize = window.getSize();
     sf::View view(sf::FloatRect(0, 0, windowSize.x, windowSize.y));
@@ -88,6 +121,11 @@ void ParticleSimulation::applyZoomAndCenter(sf::RenderWindow& window, double x,
     view.setCenter(sf::Vector2f(x + 10, y + 10));    
     view.zoom(1 / zoomFactor);
     window.setView(view);
+
+    // The server only streams what lies around this rectangle, so hand it over in particle coordinates.
+    float viewWidth = windowSize.x / zoomFactor;
+    float viewHeight = windowSize.y / zoomFactor;
+    simulationPanel.setViewRect(sf::FloatRect(x + 10 - viewWidth / 2, 720 - (y + 10 + viewHeight / 2), viewWidth, viewHeight));
 }
 
 void ParticleSimulation::setID(const json& jsonData) { 
@@ -103,22 +141,34 @@ void ParticleSimulation::setID(const json& jsonData) {
     }
 }
 
-void ParticleSimulation::addParticle(const json& jsonData, long elapsedTime) {
-    simulationPanel.parseJSONToParticles(jsonData, elapsedTime);
+void ParticleSimulation::addParticles(const std::vector<Particle>& decoded, size_t regionIndex) {
+    simulationPanel.addParticles(decoded, regionIndex);
+}
+
+void ParticleSimulation::addOtherExplorer(const json& jsonData, size_t regionIndex){
+    simulationPanel.parseJSONToExplorers(jsonData, "add", regionIndex);
 }
 
-void ParticleSimulation::addOtherExplorer(const json& jsonData){
-    simulationPanel.parseJSONToExplorers(jsonData, "add");
+void ParticleSimulation::removeExplorer(const json& jsonData, size_t regionIndex){
+    simulationPanel.parseJSONToExplorers(jsonData, "remove", regionIndex);
 }
 
-void ParticleSimulation::removeExplorer(const json& jsonData){
-    simulationPanel.parseJSONToExplorers(jsonData, "remove");
+void ParticleSimulation::removeParticles(const json& jsonData, size_t regionIndex){
+    simulationPanel.removeParticles(jsonData, regionIndex);
+}
+
+void ParticleSimulation::resetRegion(size_t regionIndex){
+    simulationPanel.resetRegion(regionIndex);
 }
 
 void ParticleSimulation::setIsRunning(){
     isRunning = false;
 }
 
+int ParticleSimulation::getID() const {
+    return ID;
+}
+
 bool ParticleSimulation::getIsRunning() const {
     return isRunning.load();
 }
@@ -0,0 +1,273 @@
+#include "PayloadCodec.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include <lz4.h>
+
+namespace {
+    // No frame the server sends decodes to more than this; a larger size means a corrupt or hostile payload.
+    const size_t MAX_DECODED_BYTES = 256 * 1024 * 1024;
+    // An LZ4 block cannot expand any byte of its input into more than 255 bytes of output.
+    const size_t LZ4_MAX_EXPANSION = 255;
+
+    // Fragments of the payloads the server sends, most frequent last since deflate reaches
+    // the end of the dictionary with the shortest distances.
+    const std::string PAYLOAD_DICTIONARY =
+        R"({"resumed":false,"codecs":["raw","gzip","lz4","dict"]}{"ids":[{"clientID":)"
+        R"({"xcoord":0.0,"ycoord":0.0,"clientID":1})"
+        R"([{"id":0,"xcoord":0.0,"ycoord":0.0,"velocity":0.0,"angle":0.0},)"
+        R"({"id":1,"xcoord":1.0,"ycoord":1.0,"velocity":1.0,"angle":1.0},{"id":)";
+
+    std::vector<char> deflateData(const std::string& data, int windowBits, const std::string* dictionary) {
+        z_stream strm = {};
+        if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("deflateInit2 failed");
+        }
+        if (dictionary != nullptr
+            && deflateSetDictionary(&strm, reinterpret_cast<const Bytef*>(dictionary->data()), dictionary->size()) != Z_OK) {
+            deflateEnd(&strm);
+            throw std::runtime_error("deflateSetDictionary failed");
+        }
+
+        std::vector<char> compressed(deflateBound(&strm, data.size()));
+        strm.avail_in = data.size();
+        strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        strm.avail_out = compressed.size();
+        strm.next_out = reinterpret_cast<Bytef*>(compressed.data());
+
+        int ret = deflate(&strm, Z_FINISH);
+        deflateEnd(&strm);
+        if (ret != Z_STREAM_END) {
+            throw std::runtime_error("deflate failed");
+        }
+        compressed.resize(strm.total_out);
+        return compressed;
+    }
+
+    std::string inflateData(const std::vector<char>& compressedData, int windowBits, const std::string* dictionary) {
+        z_stream strm = {};
+        strm.avail_in = compressedData.size();
+        strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressedData.data()));
+
+        if (inflateInit2(&strm, windowBits) != Z_OK) {
+            throw std::runtime_error("inflateInit2 failed");
+        }
+
+        int ret;
+        char outbuffer[4096];
+        std::string decompressedData;
+
+        do {
+            strm.avail_out = sizeof(outbuffer);
+            strm.next_out = reinterpret_cast<Bytef*>(outbuffer);
+            ret = inflate(&strm, Z_NO_FLUSH);
+            if (ret == Z_NEED_DICT && dictionary != nullptr) {
+                if (inflateSetDictionary(&strm, reinterpret_cast<const Bytef*>(dictionary->data()), dictionary->size()) != Z_OK) {
+                    inflateEnd(&strm);
+                    throw std::runtime_error("payload was built with a different dictionary");
+                }
+                ret = inflate(&strm, Z_NO_FLUSH);
+            }
+            switch (ret) {
+                case Z_NEED_DICT:
+                case Z_STREAM_ERROR:
+                case Z_DATA_ERROR:
+                case Z_MEM_ERROR:
+                    inflateEnd(&strm);
+                    throw std::runtime_error("inflate failed");
+            }
+            int have = sizeof(outbuffer) - strm.avail_out;
+            if (decompressedData.size() + have > MAX_DECODED_BYTES) {
+                inflateEnd(&strm);
+                throw std::runtime_error("inflated payload exceeds the size limit");
+            }
+            decompressedData.append(outbuffer, have);
+        } while (strm.avail_out == 0);
+
+        inflateEnd(&strm);
+
+        return decompressedData;
+    }
+
+    void writeUint32(char* out, uint32_t value) {
+        out[0] = static_cast<char>(value >> 24);
+        out[1] = static_cast<char>(value >> 16);
+        out[2] = static_cast<char>(value >> 8);
+        out[3] = static_cast<char>(value);
+    }
+
+    uint32_t readUint32(const char* in) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(in);
+        return (static_cast<uint32_t>(bytes[0]) << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
+    }
+
+    class RawCodec : public PayloadCodec {
+    public:
+        CodecID getID() const override { return CodecID::Raw; }
+        std::string getName() const override { return "raw"; }
+
+        std::vector<char> encode(const std::string& data) const override {
+            return std::vector<char>(data.begin(), data.end());
+        }
+
+        std::string decode(const std::vector<char>& payload) const override {
+            return std::string(payload.begin(), payload.end());
+        }
+    };
+
+    class GzipCodec : public PayloadCodec {
+    public:
+        CodecID getID() const override { return CodecID::Gzip; }
+        std::string getName() const override { return "gzip"; }
+
+        std::vector<char> encode(const std::string& data) const override {
+            return deflateData(data, 16 + MAX_WBITS, nullptr);
+        }
+
+        std::string decode(const std::vector<char>& payload) const override {
+            return inflateData(payload, 16 + MAX_WBITS, nullptr);
+        }
+    };
+
+    // LZ4 blocks do not record their decoded size, so the payload starts with it as a big-endian int.
+    class LZ4Codec : public PayloadCodec {
+    public:
+        CodecID getID() const override { return CodecID::LZ4; }
+        std::string getName() const override { return "lz4"; }
+
+        std::vector<char> encode(const std::string& data) const override {
+            std::vector<char> compressed(4 + LZ4_compressBound(data.size()));
+            writeUint32(compressed.data(), data.size());
+            int size = LZ4_compress_default(data.data(), compressed.data() + 4, data.size(), compressed.size() - 4);
+            if (size <= 0) {
+                throw std::runtime_error("LZ4 compression failed");
+            }
+            compressed.resize(4 + size);
+            return compressed;
+        }
+
+        std::string decode(const std::vector<char>& payload) const override {
+            if (payload.size() < 4) {
+                throw std::runtime_error("LZ4 payload too short");
+            }
+            // The size header is checked before it decides an allocation.
+            size_t decodedSize = readUint32(payload.data());
+            if (decodedSize > MAX_DECODED_BYTES || decodedSize > (payload.size() - 4) * LZ4_MAX_EXPANSION) {
+                throw std::runtime_error("LZ4 payload declares an impossible size of " + std::to_string(decodedSize) + " bytes");
+            }
+            std::string decompressed(decodedSize, '\0');
+            int size = LZ4_decompress_safe(payload.data() + 4, &decompressed[0], payload.size() - 4, decompressed.size());
+            if (size < 0 || static_cast<size_t>(size) != decompressed.size()) {
+                throw std::runtime_error("LZ4 decompression failed");
+            }
+            return decompressed;
+        }
+    };
+
+    // zlib format rather than gzip: its header carries the dictionary checksum, so a mismatch is caught.
+    class DictionaryCodec : public PayloadCodec {
+    public:
+        CodecID getID() const override { return CodecID::Dictionary; }
+        std::string getName() const override { return "dict"; }
+
+        std::vector<char> encode(const std::string& data) const override {
+            return deflateData(data, MAX_WBITS, &PAYLOAD_DICTIONARY);
+        }
+
+        std::string decode(const std::vector<char>& payload) const override {
+            return inflateData(payload, MAX_WBITS, &PAYLOAD_DICTIONARY);
+        }
+    };
+}
+
+const std::vector<const PayloadCodec*>& getPayloadCodecs() {
+    static const RawCodec raw;
+    static const GzipCodec gzip;
+    static const LZ4Codec lz4;
+    static const DictionaryCodec dictionary;
+    static const std::vector<const PayloadCodec*> codecs = { &raw, &gzip, &lz4, &dictionary };
+    return codecs;
+}
+
+const PayloadCodec* findPayloadCodec(uint8_t id) {
+    for (const PayloadCodec* codec : getPayloadCodecs()) {
+        if (static_cast<uint8_t>(codec->getID()) == id) {
+            return codec;
+        }
+    }
+    return nullptr;
+}
+
+const PayloadCodec* findPayloadCodec(const std::string& name) {
+    for (const PayloadCodec* codec : getPayloadCodecs()) {
+        if (codec->getName() == name) {
+            return codec;
+        }
+    }
+    return nullptr;
+}
+
+std::string decodePayload(uint8_t codec, const std::vector<char>& payload) {
+    const PayloadCodec* payloadCodec = findPayloadCodec(codec);
+    if (payloadCodec == nullptr) {
+        throw std::runtime_error("Unknown payload codec " + std::to_string(codec));
+    }
+    return payloadCodec->decode(payload);
+}
+
+const std::string& getPayloadDictionary() {
+    return PAYLOAD_DICTIONARY;
+}
+
+PayloadRecorder::PayloadRecorder(const std::string& path) : file(path, std::ios::binary | std::ios::app) {
+    if (!file) {
+        std::cerr << "Could not open payload recording " << path << std::endl;
+    }
+}
+
+bool PayloadRecorder::isOpen() const {
+    return file.is_open();
+}
+
+// Record layout: type length (2 bytes) and type, codec id (1 byte), payload length (4 bytes) and payload.
+void PayloadRecorder::record(const std::string& type, uint8_t codec, const std::vector<char>& payload) {
+    char header[7];
+    header[0] = static_cast<char>(type.size() >> 8);
+    header[1] = static_cast<char>(type.size());
+    header[2] = static_cast<char>(codec);
+    writeUint32(header + 3, payload.size());
+
+    std::lock_guard<std::mutex> lock(fileMutex);
+    file.write(header, 2);
+    file.write(type.data(), type.size());
+    file.write(header + 2, 5);
+    file.write(payload.data(), payload.size());
+}
+
+bool readPayloadRecording(const std::string& path, std::vector<RecordedPayload>& payloads) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    char typeLength[2];
+    while (file.read(typeLength, 2)) {
+        RecordedPayload recorded;
+        recorded.type.resize((static_cast<unsigned char>(typeLength[0]) << 8) | static_cast<unsigned char>(typeLength[1]));
+        char header[5];
+        if (!file.read(&recorded.type[0], recorded.type.size()) || !file.read(header, 5)) {
+            return false;
+        }
+        recorded.codec = static_cast<uint8_t>(header[0]);
+        recorded.payload.resize(readUint32(header + 1));
+        if (!file.read(recorded.payload.data(), recorded.payload.size())) {
+            return false;
+        }
+        payloads.push_back(std::move(recorded));
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+#include "Particle.hpp"
+
+// Steps the same particles in float and double and checks that single precision stays within
+// the documented bounds. Both run the client's integrator with the shard tick of 0.1 seconds.
+namespace {
+    const double TICK_SECONDS = 0.1;
+    const size_t PARTICLE_COUNT = 2000;
+    const int DRIFT_TICKS = 100;
+
+    // Largest position error, in world units, that one tick may add when both start from the same state.
+    // A float ulp near the far edge of the 1280 unit world is about 1.2e-4.
+    const double TICK_ERROR_BOUND = 1e-3;
+    // Largest difference allowed after DRIFT_TICKS ticks of stepping each precision on its own.
+    // Per-tick errors accumulate and a wall bounce can flip a tick apart, so this is looser.
+    const double DRIFT_ERROR_BOUND = 0.05;
+
+    struct InitialState {
+        double x;
+        double y;
+        double velocity;
+        double angle;
+    };
+
+    std::vector<InitialState> makeStates() {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> x(1, 1279);
+        std::uniform_real_distribution<double> y(1, 719);
+        std::uniform_real_distribution<double> velocity(10, 100);
+        std::uniform_real_distribution<double> angle(0, 360);
+
+        std::vector<InitialState> states;
+        for (size_t i = 0; i < PARTICLE_COUNT; i++) {
+            states.push_back({ x(rng), y(rng), velocity(rng), angle(rng) });
+        }
+        return states;
+    }
+
+    template <typename Real>
+    BasicParticle<Real> makeParticle(double x, double y, double velocity, double angle) {
+        return BasicParticle<Real>(static_cast<Real>(x), static_cast<Real>(y), static_cast<Real>(velocity), static_cast<Real>(angle));
+    }
+
+    template <typename A, typename B>
+    double distance(const A& a, const B& b) {
+        return std::hypot(static_cast<double>(a.getXCoord()) - static_cast<double>(b.getXCoord()),
+                          static_cast<double>(a.getYCoord()) - static_cast<double>(b.getYCoord()));
+    }
+
+    // Restarts the float particle from the double state before every tick, so only one step's error is measured.
+    double maxTickError(const std::vector<InitialState>& states) {
+        double maxError = 0;
+        for (const auto& state : states) {
+            auto reference = makeParticle<double>(state.x, state.y, state.velocity, state.angle);
+            for (int tick = 0; tick < DRIFT_TICKS; tick++) {
+                auto single = makeParticle<float>(reference.getXCoord(), reference.getYCoord(),
+                                                  reference.getVelocity(), reference.getAngle());
+                reference.updatePosition(TICK_SECONDS);
+                single.updatePosition(static_cast<float>(TICK_SECONDS));
+                maxError = std::max(maxError, distance(reference, single));
+            }
+        }
+        return maxError;
+    }
+
+    double maxDrift(const std::vector<InitialState>& states) {
+        double maxError = 0;
+        for (const auto& state : states) {
+            auto reference = makeParticle<double>(state.x, state.y, state.velocity, state.angle);
+            auto single = makeParticle<float>(state.x, state.y, state.velocity, state.angle);
+            for (int tick = 0; tick < DRIFT_TICKS; tick++) {
+                reference.updatePosition(TICK_SECONDS);
+                single.updatePosition(static_cast<float>(TICK_SECONDS));
+            }
+            maxError = std::max(maxError, distance(reference, single));
+        }
+        return maxError;
+    }
+
+    bool check(const std::string& name, double error, double bound) {
+        bool passed = error <= bound;
+        std::cout << (passed ? "PASS " : "FAIL ") << name << ": max error " << error << " (bound " << bound << ")" << std::endl;
+        return passed;
+    }
+}
+
+int main() {
+    auto states = makeStates();
+
+    bool passed = check("single tick", maxTickError(states), TICK_ERROR_BOUND);
+    passed = check(std::to_string(DRIFT_TICKS) + " ticks", maxDrift(states), DRIFT_ERROR_BOUND) && passed;
+
+    return passed ? 0 : 1;
+}
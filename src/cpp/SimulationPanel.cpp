@@ -5,62 +5,135 @@
 #include <cmath>
 #include <algorithm>
 #include <chrono>
+#include <sstream>
+#include <iomanip>
 #include <boost/thread.hpp>
 #include <mutex>
 #include <memory>
+#include <unordered_set>
 #include <nlohmann/json.hpp>
 #include <SFML/Graphics.hpp>
 
 #include "Particle.hpp"
 #include "Explorer.hpp"
+#include "DensityMap.hpp"
+#include "SimulationShard.hpp"
+#include "Precision.hpp"
+#include "FrameTimeHistogram.hpp"
+#include "SpatialOrder.hpp"
 #include <corecrt_math_defines.h>
 
 using json = nlohmann::json;
 
+namespace {
+    // Above this many particles per screen pixel individual circles overlap into noise,
+    // so the panel switches to the density map.
+    const double LOD_DENSITY_THRESHOLD = 0.02;
+    // Particles within this distance of the explorer are still drawn individually.
+    const double LOD_SPRITE_RADIUS = 100.0;
+    const float PARTICLE_RADIUS = 5.0f;
+    const float WORLD_HEIGHT = 720.0f;
+}
+
 SimulationPanel::SimulationPanel() {
     explorer = nullptr;
-    frameCount = 0;
-    previousFPS = 0;
-    lastFPSCheck = std::chrono::high_resolution_clock::now();
-    particles.reserve(1000);
+    renderFrameCount = 0;
+    previousRenderFPS = 0;
+    lastRenderFPSCheck = std::chrono::high_resolution_clock::now();
+    lastHistogramCheck = lastRenderFPSCheck;
+    frameTimeP50 = 0;
+    frameTimeP95 = 0;
+    frameTimeP99 = 0;
     explorers.reserve(5);
+    setRegions({ sf::FloatRect(0, 0, 1280, 720) });
 
     if (!font.loadFromFile("../../lib/calibri.ttf")) {
         std::cerr << "Failed to load font file" << std::endl;
     }
 }
 
-void SimulationPanel::parseJSONToParticles(const json& jsonData , long elapsedTime) {
-    if (jsonData.is_array()) {
-        for (const auto& obj : jsonData) {
-            double angle = obj.at("angle").get<double>();
-            double velocity = obj.at("velocity").get<double>();
-            double xcoord = obj.at("xcoord").get<double>();
-            double ycoord = obj.at("ycoord").get<double>();
+// Must be called before the shard threads start.
+void SimulationPanel::setRegions(const std::vector<sf::FloatRect>& regions) {
+    shards.clear();
+    for (size_t i = 0; i < regions.size(); i++) {
+        shards.push_back(std::make_unique<SimulationShard>(static_cast<int>(i), regions[i]));
+        shards.back()->setReordering(reorderInterval, reorderCurve);
+
+        std::vector<sf::FloatRect> others = regions;
+        others.erase(others.begin() + i);
+        shards.back()->setOtherRegions(others);
+    }
+}
+
+// Must be called before the shard threads start.
+void SimulationPanel::setParticleReordering(int intervalTicks, SpaceFillingCurve curve) {
+    reorderInterval = intervalTicks;
+    reorderCurve = curve;
+    for (auto& shard : shards) {
+        shard->setReordering(intervalTicks, curve);
+    }
+}
+
+size_t SimulationPanel::getShardCount() const {
+    return shards.size();
+}
 
-            particles.push_back(std::make_shared<Particle>(xcoord, ycoord, velocity, angle));
+void SimulationPanel::placeParticle(const Particle& particle, size_t fallbackIndex) {
+    for (const auto& shard : shards) {
+        if (shard->contains(particle.getXCoord(), particle.getYCoord())) {
+            shard->handOff(particle);
+            return;
         }
-    } else {
-        double angle = jsonData["angle"];
-        double velocity = jsonData["velocity"];
-        double xcoord = jsonData["xcoord"];
-        double ycoord = jsonData["ycoord"];
+    }
+    // Outside every configured region: the shard it came from keeps it, and keeps stepping it
+    // since no other region claims it.
+    shards[fallbackIndex]->handOff(particle);
+}
 
-        double angleRadians = angle * M_PI / 180;
-        double Time = static_cast<double>(elapsedTime) / 1000;
-        double displacement = velocity * Time;
-        double NewX = xcoord + (displacement * cos(angleRadians));
-        double NewY = ycoord + (displacement * sin(angleRadians));
+Particle SimulationPanel::decodeParticle(const json& obj) {
+    SimReal angle = obj.at("angle").get<SimReal>();
+    SimReal velocity = obj.at("velocity").get<SimReal>();
+    SimReal xcoord = obj.at("xcoord").get<SimReal>();
+    SimReal ycoord = obj.at("ycoord").get<SimReal>();
+    int id = obj.value("id", -1);
+
+    return Particle(xcoord, ycoord, velocity, angle, id);
+}
 
-        std::cout << "Elapsed Time: " << Time << std::endl;
-        std::cout << "NewX: " << NewX << " NewY: " << NewY << std::endl;
+// A single particle is broadcast when it is added, so it is moved forward by the time it spent in transit.
+Particle SimulationPanel::decodeExtrapolatedParticle(const json& jsonData, long elapsedTime) {
+    SimReal angle = jsonData["angle"].get<SimReal>();
+    SimReal velocity = jsonData["velocity"].get<SimReal>();
+    SimReal xcoord = jsonData["xcoord"].get<SimReal>();
+    SimReal ycoord = jsonData["ycoord"].get<SimReal>();
+    int id = jsonData.value("id", -1);
+
+    SimReal angleRadians = angle * static_cast<SimReal>(M_PI) / 180;
+    SimReal Time = static_cast<SimReal>(elapsedTime) / 1000;
+    SimReal displacement = velocity * Time;
+    SimReal NewX = xcoord + (displacement * std::cos(angleRadians));
+    SimReal NewY = ycoord + (displacement * std::sin(angleRadians));
+
+    std::cout << "Elapsed Time: " << Time << std::endl;
+    std::cout << "NewX: " << NewX << " NewY: " << NewY << std::endl;
+
+    return Particle(NewX, NewY, velocity, angle, id);
+}
 
-        particles.push_back(std::make_shared<Particle>(NewX, NewY, velocity, angle));
+void SimulationPanel::addParticles(const std::vector<Particle>& decoded, size_t regionIndex) {
+    for (Particle particle : decoded) {
+        particle.setOrigin(static_cast<int>(regionIndex));
+        placeParticle(particle, regionIndex);
     }
 }
 
-void SimulationPanel::parseJSONToExplorers(const json& jsonData, const std::string& type) {
-    auto updateOrAddExplorer = [this](int id, double xcoord, double ycoord) {
+// Every region's server reports the same explorer under the same ID, since the client gives each
+// server one identity. The explorer is kept while any region still reports it.
+void SimulationPanel::parseJSONToExplorers(const json& jsonData, const std::string& type, size_t regionIndex) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    auto updateOrAddExplorer = [this, regionIndex](int id, double xcoord, double ycoord) {
+        explorerSources[id].insert(regionIndex);
+
         auto it = std::find_if(explorers.begin(), explorers.end(),
             [id](const std::shared_ptr<Explorer>& explorer) { return explorer->getID() == id; });
 
@@ -71,15 +144,6 @@ void SimulationPanel::parseJSONToExplorers(const json& jsonData, const std::stri
         }
     };
 
-    auto removeExplorer = [this](int id) {
-        auto it = std::find_if(explorers.begin(), explorers.end(),
-            [id](const std::shared_ptr<Explorer>& explorer) { return explorer->getID() == id; });
-
-        if (it != explorers.end()) {
-            explorers.erase(it);
-        } 
-    };
-
     if (type == "add"){
         if (jsonData.is_array()) {
             for (const auto& obj : jsonData) {
@@ -103,16 +167,47 @@ void SimulationPanel::parseJSONToExplorers(const json& jsonData, const std::stri
             for (const auto& obj : jsonData) {
                 int id = obj.at("clientID").get<int>();
 
-                removeExplorer(id);
+                dropExplorerSource(id, regionIndex);
             }
         } else {
             int id = jsonData["clientID"].get<int>();
 
-            removeExplorer(id);
+            dropExplorerSource(id, regionIndex);
         }
     }
 }
 
+// Callers hold stateMutex.
+void SimulationPanel::dropExplorerSource(int id, size_t regionIndex) {
+    auto sources = explorerSources.find(id);
+    if (sources != explorerSources.end()) {
+        sources->second.erase(regionIndex);
+        if (!sources->second.empty()) {
+            return;
+        }
+        explorerSources.erase(sources);
+    }
+
+    auto it = std::find_if(explorers.begin(), explorers.end(),
+        [id](const std::shared_ptr<Explorer>& explorer) { return explorer->getID() == id; });
+
+    if (it != explorers.end()) {
+        explorers.erase(it);
+    }
+}
+
+// Particle IDs are only unique per server, so a Leave only applies to particles from the region that sent it.
+void SimulationPanel::removeParticles(const json& jsonData, size_t regionIndex) {
+    std::unordered_set<int> ids;
+    for (const auto& id : jsonData.at("ids")) {
+        ids.insert(id.get<int>());
+    }
+
+    for (auto& shard : shards) {
+        shard->removeParticles(static_cast<int>(regionIndex), ids);
+    }
+}
+
 void SimulationPanel::addExplorer(int ID, double x, double y) {
     explorer = std::make_shared<Explorer>(ID, x, y);
     std::cout << "explorer move: " << explorer->getMove() << std::endl;
@@ -122,20 +217,78 @@ const std::shared_ptr<Explorer>& SimulationPanel::getExplorer() const {
     return explorer;
 }
 
-void SimulationPanel::updateSimulation() {
-    for (auto& particle : particles) {
-        particle->updatePosition(0.1);
+// The area the explorer currently sees, in particle coordinates. Empty until an explorer is placed.
+void SimulationPanel::setViewRect(const sf::FloatRect& rect) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    viewRect = rect;
+}
+
+sf::FloatRect SimulationPanel::getViewRect() const {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    return viewRect;
+}
+
+void SimulationPanel::updateSimulation(size_t shardIndex) {
+    std::vector<Particle> leaving;
+    shards[shardIndex]->update(0.1, leaving);
+
+    for (const auto& particle : leaving) {
+        placeParticle(particle, shardIndex);
     }
+}
+
+void SimulationPanel::recordFrame(double frameMillis) {
+    frameTimes.record(frameMillis);
+    renderFrameCount++;
 
-    frameCount++;
-    
     auto currentTime = std::chrono::high_resolution_clock::now();
-    auto timeDiff = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - lastFPSCheck).count();
+    auto timeDiff = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - lastRenderFPSCheck).count();
 
     if (timeDiff >= 500) {
-        previousFPS = frameCount / (timeDiff / 1000.0);
-        frameCount = 0;
-        lastFPSCheck = currentTime; 
+        previousRenderFPS = renderFrameCount / (timeDiff / 1000.0);
+        renderFrameCount = 0;
+        lastRenderFPSCheck = currentTime;
+    }
+
+    // Percentiles need more samples than the FPS counter, so they cover a longer window.
+    auto histogramDiff = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - lastHistogramCheck).count();
+
+    if (histogramDiff >= 2000) {
+        frameTimeP50 = frameTimes.percentile(50);
+        frameTimeP95 = frameTimes.percentile(95);
+        frameTimeP99 = frameTimes.percentile(99);
+        sessionFrameTimes.merge(frameTimes);
+        frameTimes.reset();
+        lastHistogramCheck = currentTime;
+    }
+}
+
+bool SimulationPanel::exportFrameTimes(const std::string& path) const {
+    FrameTimeHistogram session = sessionFrameTimes;
+    session.merge(frameTimes);
+
+    std::cout << "Frame time over " << session.getCount() << " frames: p50 " << session.percentile(50)
+              << " ms, p95 " << session.percentile(95) << " ms, p99 " << session.percentile(99) << " ms" << std::endl;
+
+    return session.exportCSV(path);
+}
+
+// Drops what one region's server reported. Its particles may have moved into any shard,
+// and explorers other regions still report are kept.
+void SimulationPanel::resetRegion(size_t regionIndex) {
+    for (auto& shard : shards) {
+        shard->removeOrigin(static_cast<int>(regionIndex));
+    }
+
+    std::lock_guard<std::mutex> lock(stateMutex);
+    std::vector<int> reported;
+    for (const auto& sources : explorerSources) {
+        if (sources.second.count(regionIndex) > 0) {
+            reported.push_back(sources.first);
+        }
+    }
+    for (int id : reported) {
+        dropExplorerSource(id, regionIndex);
     }
 }
 
@@ -144,13 +297,59 @@ void SimulationPanel::draw(sf::RenderTarget& target, sf::RenderStates states) co
     
     target.clear(sf::Color::White);
 
-    for (const auto& particle : particles) {
-        target.draw(*particle);
+    size_t particleCount = 0;
+    for (const auto& shard : shards) {
+        particleCount += shard->size();
     }
 
+    if (useDensityMap(target, particleCount)) {
+        // One pass per shard under its lock bins every particle and picks out those near the explorer.
+        // Only positions leave the lock, so the sprites are drawn without holding up the shard threads.
+        sf::Vector2f focus;
+        float radius = 0;
+        if (explorer) {
+            focus = sf::Vector2f(static_cast<float>(explorer->getXCoord() + 10), static_cast<float>(explorer->getYCoord() + 10));
+            radius = static_cast<float>(LOD_SPRITE_RADIUS);
+        }
+
+        std::vector<sf::Vector2f> nearExplorer;
+        densityMap.clear();
+        for (const auto& shard : shards) {
+            shard->withParticles([&](const std::vector<Particle>& particles) {
+                densityMap.accumulate(particles, focus, radius, nearExplorer);
+            });
+        }
+        densityMap.upload();
+        target.draw(densityMap);
+
+        sf::CircleShape sprite;
+        sprite.setRadius(PARTICLE_RADIUS);
+        sprite.setFillColor(sf::Color::Red);
+        for (const auto& position : nearExplorer) {
+            sprite.setPosition(position.x - PARTICLE_RADIUS, position.y - PARTICLE_RADIUS);
+            target.draw(sprite);
+        }
+    } else {
+        // Particles hold no shape of their own; one circle is moved to each of them in turn.
+        sf::CircleShape sprite;
+        sprite.setRadius(PARTICLE_RADIUS);
+        sprite.setFillColor(sf::Color::Red);
+        for (const auto& shard : shards) {
+            shard->withParticles([&target, &sprite](const std::vector<Particle>& particles) {
+                for (const auto& particle : particles) {
+                    sprite.setPosition(static_cast<float>(particle.getXCoord()) - PARTICLE_RADIUS,
+                                       WORLD_HEIGHT - static_cast<float>(particle.getYCoord()) - PARTICLE_RADIUS);
+                    target.draw(sprite);
+                }
+            });
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(stateMutex);
     for (const auto& others : explorers) {
         target.draw(*others);
     }
+    lock.unlock();
 
     if (explorer) {
         target.draw(*explorer);
@@ -163,6 +362,19 @@ void SimulationPanel::draw(sf::RenderTarget& target, sf::RenderStates states) co
     target.setView(originalView);   
 }
 
+bool SimulationPanel::useDensityMap(const sf::RenderTarget& target, size_t particleCount) const {
+    sf::Vector2u targetSize = target.getSize();
+    if (particleCount == 0 || targetSize.x == 0 || targetSize.y == 0) {
+        return false;
+    }
+
+    // Estimate the particles in view from the share of the world the view covers.
+    const sf::Vector2f& viewSize = target.getView().getSize();
+    double visibleShare = std::min(1.0, (static_cast<double>(viewSize.x) * viewSize.y) / (1280.0 * 720.0));
+    double particlesPerPixel = particleCount * visibleShare / (static_cast<double>(targetSize.x) * targetSize.y);
+
+    return particlesPerPixel > LOD_DENSITY_THRESHOLD;
+}
 
 void SimulationPanel::drawFPSInfo(sf::RenderTarget& target) const {
     sf::Text text;
@@ -171,7 +383,19 @@ void SimulationPanel::drawFPSInfo(sf::RenderTarget& target) const {
     text.setFillColor(sf::Color::Green);
     text.setPosition(10, 20);
 
-    text.setString("FPS: " + std::to_string(static_cast<int>(previousFPS)));
+    std::string simRates;
+    for (const auto& shard : shards) {
+        simRates += (simRates.empty() ? "" : "/") + std::to_string(shard->getTicksPerSecond());
+    }
+    text.setString("Sim: " + simRates + " ticks/s  Render: " + std::to_string(previousRenderFPS) + " FPS");
+
+    target.draw(text);
+
+    std::ostringstream frameTimeInfo;
+    frameTimeInfo << std::fixed << std::setprecision(1) << "Frame ms p50 " << frameTimeP50
+                  << "  p95 " << frameTimeP95 << "  p99 " << frameTimeP99;
+    text.setPosition(10, 36);
+    text.setString(frameTimeInfo.str());
 
     target.draw(text);
 }
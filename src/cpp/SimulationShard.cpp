@@ -0,0 +1,186 @@
+#include "SimulationShard.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <chrono>
+#include <unordered_set>
+#include <cstdint>
+#include <SFML/Graphics.hpp>
+
+#include "Particle.hpp"
+#include "SpatialOrder.hpp"
+
+template <typename Real>
+BasicSimulationShard<Real>::BasicSimulationShard(int index, const sf::FloatRect& bounds)
+    : index(index), bounds(bounds), reorderInterval(0), ticksSinceReorder(0), reorderCurve(SpaceFillingCurve::Hilbert),
+      membershipVersion(0), tickCount(0), ticksPerSecond(0) {
+    lastTickCheck = std::chrono::high_resolution_clock::now();
+    particles.reserve(1000);
+}
+
+template <typename Real>
+void BasicSimulationShard<Real>::addParticle(const ParticleType& particle) {
+    std::lock_guard<std::mutex> lock(particleMutex);
+    particles.push_back(particle);
+    membershipVersion++;
+}
+
+template <typename Real>
+void BasicSimulationShard<Real>::handOff(const ParticleType& particle) {
+    // Neighbours only touch the inbox, so they never wait on this shard's update.
+    std::lock_guard<std::mutex> lock(inboxMutex);
+    inbox.push_back(particle);
+}
+
+template <typename Real>
+void BasicSimulationShard<Real>::update(Real time, std::vector<ParticleType>& leaving) {
+    std::vector<ParticleType> arrived;
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex);
+        arrived.swap(inbox);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(particleMutex);
+        particles.insert(particles.end(), arrived.begin(), arrived.end());
+
+        for (auto& particle : particles) {
+            particle.updatePosition(time);
+        }
+
+        auto staying = std::partition(particles.begin(), particles.end(), [this](const ParticleType& particle) {
+            return contains(particle.getXCoord(), particle.getYCoord())
+                || !ownedElsewhere(particle.getXCoord(), particle.getYCoord());
+        });
+        leaving.insert(leaving.end(), staying, particles.end());
+        particles.erase(staying, particles.end());
+        membershipVersion++;
+    }
+
+    // Sorted outside the lock so drawing is not held up. If particles arrive or leave meanwhile
+    // the result is dropped and the next tick tries again.
+    if (reorderInterval > 0 && ++ticksSinceReorder >= reorderInterval && sortByCurve()) {
+        ticksSinceReorder = 0;
+    }
+
+    tickCount++;
+
+    auto currentTime = std::chrono::high_resolution_clock::now();
+    auto timeDiff = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - lastTickCheck).count();
+
+    if (timeDiff >= 500) {
+        ticksPerSecond = tickCount / (timeDiff / 1000.0);
+        tickCount = 0;
+        lastTickCheck = currentTime;
+    }
+}
+
+template <typename Real>
+void BasicSimulationShard<Real>::removeParticles(int origin, const std::unordered_set<int>& ids) {
+    removeIf([origin, &ids](const ParticleType& particle) {
+        return particle.getOrigin() == origin && ids.count(particle.getID()) > 0;
+    });
+}
+
+template <typename Real>
+void BasicSimulationShard<Real>::removeOrigin(int origin) {
+    removeIf([origin](const ParticleType& particle) {
+        return particle.getOrigin() == origin;
+    });
+}
+
+// An interval of 0 turns reordering off. Must be called before the shard thread starts.
+template <typename Real>
+void BasicSimulationShard<Real>::setReordering(int intervalTicks, SpaceFillingCurve curve) {
+    reorderInterval = std::max(0, intervalTicks);
+    reorderCurve = curve;
+    ticksSinceReorder = 0;
+}
+
+// The regions of the other shards. Must be called before the shard thread starts.
+template <typename Real>
+void BasicSimulationShard<Real>::setOtherRegions(const std::vector<sf::FloatRect>& regions) {
+    otherRegions = regions;
+}
+
+template <typename Real>
+bool BasicSimulationShard<Real>::ownedElsewhere(double x, double y) const {
+    return std::any_of(otherRegions.begin(), otherRegions.end(), [x, y](const sf::FloatRect& region) {
+        return region.contains(static_cast<float>(x), static_cast<float>(y));
+    });
+}
+
+// False if particles were added or removed while sorting; nothing changes then.
+template <typename Real>
+bool BasicSimulationShard<Real>::reorder() {
+    return sortByCurve();
+}
+
+// Must run on the thread that steps the shard, so positions cannot change between the snapshot and the swap.
+// The lock is only held to copy the particles out and to swap the sorted copy in.
+template <typename Real>
+bool BasicSimulationShard<Real>::sortByCurve() {
+    std::vector<ParticleType> snapshot;
+    uint64_t version;
+    {
+        std::lock_guard<std::mutex> lock(particleMutex);
+        snapshot = particles;
+        version = membershipVersion;
+    }
+
+    size_t count = snapshot.size();
+    std::vector<uint32_t> keys(count);
+    std::vector<uint32_t> order(count);
+
+    double scaleX = 65535.0 / std::max(1.0f, bounds.width);
+    double scaleY = 65535.0 / std::max(1.0f, bounds.height);
+    for (size_t i = 0; i < count; i++) {
+        double x = std::clamp((snapshot[i].getXCoord() - bounds.left) * scaleX, 0.0, 65535.0);
+        double y = std::clamp((snapshot[i].getYCoord() - bounds.top) * scaleY, 0.0, 65535.0);
+        keys[i] = curveKey(reorderCurve, static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+        order[i] = static_cast<uint32_t>(i);
+    }
+
+    radixSortByKey(keys, order);
+
+    std::vector<ParticleType> sorted;
+    sorted.reserve(std::max<size_t>(count, 1000));
+    for (uint32_t i : order) {
+        sorted.push_back(snapshot[i]);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(particleMutex);
+        if (version != membershipVersion) {
+            return false;
+        }
+        particles.swap(sorted);
+    }
+    // The previous vector is released here, outside the lock.
+    return true;
+}
+
+template <typename Real>
+bool BasicSimulationShard<Real>::contains(double x, double y) const {
+    return bounds.contains(static_cast<float>(x), static_cast<float>(y));
+}
+
+template <typename Real>
+int BasicSimulationShard<Real>::getIndex() const {
+    return index;
+}
+
+template <typename Real>
+size_t BasicSimulationShard<Real>::size() const {
+    std::lock_guard<std::mutex> lock(particleMutex);
+    return particles.size();
+}
+
+template <typename Real>
+int BasicSimulationShard<Real>::getTicksPerSecond() const {
+    return ticksPerSecond.load();
+}
+
+template class BasicSimulationShard<float>;
+template class BasicSimulationShard<double>;
@@ -0,0 +1,128 @@
+#include "SpatialOrder.hpp"
+
+#include <vector>
+#include <array>
+#include <string>
+#include <algorithm>
+#include <boost/thread.hpp>
+
+namespace {
+    const int RADIX_BITS = 8;
+    const size_t RADIX_SIZE = 1 << RADIX_BITS;
+    const uint32_t GRID_SIZE = 1 << 16;
+    // Below this many keys per thread a pass is faster on one thread.
+    const size_t KEYS_PER_THREAD = 65536;
+
+    uint32_t spreadBits(uint32_t value) {
+        value &= 0x0000FFFF;
+        value = (value | (value << 8)) & 0x00FF00FF;
+        value = (value | (value << 4)) & 0x0F0F0F0F;
+        value = (value | (value << 2)) & 0x33333333;
+        value = (value | (value << 1)) & 0x55555555;
+        return value;
+    }
+
+    template <typename Function>
+    void forEachChunk(size_t threadCount, Function function) {
+        if (threadCount == 1) {
+            function(0);
+            return;
+        }
+        boost::thread_group workers;
+        for (size_t t = 0; t < threadCount; t++) {
+            workers.create_thread([&function, t]() {
+                function(t);
+            });
+        }
+        workers.join_all();
+    }
+}
+
+bool parseSpaceFillingCurve(const std::string& name, SpaceFillingCurve& curve) {
+    if (name == "morton") {
+        curve = SpaceFillingCurve::Morton;
+    } else if (name == "hilbert") {
+        curve = SpaceFillingCurve::Hilbert;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+uint32_t mortonKey(uint32_t x, uint32_t y) {
+    return spreadBits(x) | (spreadBits(y) << 1);
+}
+
+uint32_t hilbertKey(uint32_t x, uint32_t y) {
+    x = std::min(x, GRID_SIZE - 1);
+    y = std::min(y, GRID_SIZE - 1);
+
+    uint32_t key = 0;
+    for (uint32_t s = GRID_SIZE / 2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        key += s * s * ((3 * rx) ^ ry);
+
+        // Rotate the quadrant so the curve stays continuous across it.
+        if (ry == 0) {
+            if (rx == 1) {
+                x = GRID_SIZE - 1 - x;
+                y = GRID_SIZE - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return key;
+}
+
+uint32_t curveKey(SpaceFillingCurve curve, uint32_t x, uint32_t y) {
+    return curve == SpaceFillingCurve::Hilbert ? hilbertKey(x, y) : mortonKey(x, y);
+}
+
+void radixSortByKey(std::vector<uint32_t>& keys, std::vector<uint32_t>& values) {
+    size_t count = keys.size();
+    size_t threadCount = std::max<size_t>(1, std::min<size_t>(boost::thread::hardware_concurrency(), count / KEYS_PER_THREAD));
+    size_t chunk = (count + threadCount - 1) / threadCount;
+
+    std::vector<uint32_t> keyBuffer(count);
+    std::vector<uint32_t> valueBuffer(count);
+    std::vector<std::array<size_t, RADIX_SIZE>> offsets(threadCount);
+
+    for (int shift = 0; shift < 32; shift += RADIX_BITS) {
+        forEachChunk(threadCount, [&](size_t t) {
+            offsets[t].fill(0);
+            size_t end = std::min(count, (t + 1) * chunk);
+            for (size_t i = t * chunk; i < end; i++) {
+                offsets[t][(keys[i] >> shift) & (RADIX_SIZE - 1)]++;
+            }
+        });
+
+        // Digit-major, thread-minor offsets keep equal digits in their previous order, which makes the sort stable.
+        size_t offset = 0;
+        bool singleDigit = false;
+        for (size_t digit = 0; digit < RADIX_SIZE; digit++) {
+            size_t digitCount = 0;
+            for (size_t t = 0; t < threadCount; t++) {
+                size_t threadDigitCount = offsets[t][digit];
+                offsets[t][digit] = offset;
+                offset += threadDigitCount;
+                digitCount += threadDigitCount;
+            }
+            singleDigit = singleDigit || digitCount == count;
+        }
+        if (singleDigit) {
+            continue;
+        }
+
+        forEachChunk(threadCount, [&](size_t t) {
+            size_t end = std::min(count, (t + 1) * chunk);
+            for (size_t i = t * chunk; i < end; i++) {
+                size_t position = offsets[t][(keys[i] >> shift) & (RADIX_SIZE - 1)]++;
+                keyBuffer[position] = keys[i];
+                valueBuffer[position] = values[i];
+            }
+        });
+        keys.swap(keyBuffer);
+        values.swap(valueBuffer);
+    }
+}
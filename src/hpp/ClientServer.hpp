@@ -13,16 +13,35 @@
 #include <boost/thread.hpp>
 
 #include "ParticleSimulation.hpp"
+#include "PayloadCodec.hpp"
 
 using boost::asio::ip::tcp;
 namespace asio = boost::asio;
 using boost::system::error_code;
 using json = nlohmann::json;
 
+class ConnectionManager;
+
+// One message from the server: UTF type, send time, session sequence number, the codec id once
+// the connection negotiated codecs, and the encoded JSON body (gzip before that).
+struct ServerFrame {
+    std::string type;
+    uint64_t serverTime = 0; // network byte order, as expected by getTimeDifference
+    uint64_t sequence = 0;
+    uint8_t codec = static_cast<uint8_t>(CodecID::Gzip);
+    std::vector<char> payload;
+};
+
 std::vector<char> prepareMessageForJavaUTF(const std::string& message);
 std::string decompressGzip(const std::vector<char>& compressedData);
+bool readServerFrame(tcp::socket& socket, ServerFrame& frame, error_code& ec, bool hasCodec = false);
+size_t parseServerFrame(const char* data, size_t size, ServerFrame& frame, bool hasCodec = false);
+std::string formatCodecOffer(const std::vector<std::string>& codecs);
+std::string clientConfigPath();
 
-void sendExplorerToServer(asio::ip::tcp::socket& socket, SimulationPanel& SimPanel);
+std::string formatExplorerMessage(double x, double y);
+std::string formatExplorerMessage(double x, double y, const sf::FloatRect& view);
+bool sendExplorerToServer(ConnectionManager& connection, SimulationPanel& SimPanel);
 
 uint64_t ntohll(uint64_t value);
 long long getTimeDifference(uint64_t javaTimeMillis);
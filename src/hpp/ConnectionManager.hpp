@@ -0,0 +1,68 @@
+#ifndef CONNECTION_MANAGER_HPP
+#define CONNECTION_MANAGER_HPP
+
+#include <boost/asio.hpp>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+#include "ClientServer.hpp"
+#include "ParticleSimulation.hpp"
+
+using boost::asio::ip::tcp;
+namespace asio = boost::asio;
+using boost::system::error_code;
+using json = nlohmann::json;
+
+// Owns the server socket and keeps the session alive across dropped connections.
+// Frames are numbered per session by the server; after a reconnect the manager asks
+// for a resume from the last applied sequence number instead of a full state download.
+// Payload codecs are negotiated again on every connection.
+// The same client identity is announced to every server, so they all report this client's explorer under one ID.
+class ConnectionManager {
+public:
+    ConnectionManager(const std::string& ip, const std::string& port, int initialBackoffMs, int maxBackoffMs);
+
+    bool connectWithBackoff(const ParticleSimulation& simulation);
+    void disconnect();
+
+    bool readFrame(ServerFrame& frame, error_code& ec);
+    bool send(const std::string& message);
+
+    void setCodecs(const std::vector<std::string>& codecs);
+    void acceptCodecs(const json& jsonData);
+
+    void setIdentity(int identity);
+    void setClientID(int clientID);
+    void requestResume();
+    bool shouldApply(const ServerFrame& frame);
+    bool applySession(const json& jsonData);
+
+    bool isReady() const;
+    bool hasSession() const;
+
+private:
+    asio::io_context io_context;
+    tcp::socket socket;
+    std::string server_ip;
+    std::string server_port;
+    int initialBackoffMs;
+    int maxBackoffMs;
+
+    bool write(const std::string& message);
+
+    std::mutex socketMutex;
+    std::atomic<bool> connected = false;
+    std::vector<std::string> offeredCodecs;
+    int identity = -1;
+    bool codecFraming = false;
+    std::atomic<uint64_t> lastSequence = 0;
+    int clientID = -1;
+    bool sessionStarted = false;
+    std::atomic<bool> awaitingSession = false;
+};
+
+#endif // CONNECTION_MANAGER_HPP
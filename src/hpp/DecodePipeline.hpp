@@ -0,0 +1,85 @@
+#ifndef DECODE_PIPELINE_HPP
+#define DECODE_PIPELINE_HPP
+
+#include <boost/asio/thread_pool.hpp>
+#include <boost/thread.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "ClientServer.hpp"
+#include "Particle.hpp"
+
+namespace asio = boost::asio;
+using json = nlohmann::json;
+
+// A server frame after the decode stage. Particle arrays arrive already turned into particles.
+struct DecodedFrame {
+    uint64_t ordinal = 0;
+    std::string type;
+    uint64_t sequence = 0;
+    long elapsedTime = 0;
+    json data;
+    std::vector<Particle> particles;
+    bool failed = false;
+    std::string error;
+    std::chrono::steady_clock::time_point receivedAt;
+    std::chrono::steady_clock::time_point decodedAt;
+};
+
+// Three stages per connection: the reader thread only frames bytes and submits them, a shared
+// worker pool decodes and parses (converting large particle arrays to particles in chunks), and a dedicated
+// apply thread commits the results in the order the frames were read, which is sequence order.
+// Once maxInFlight frames are submitted but not yet applied, submitting blocks the reader.
+// A report thread prints queue depths and stage timings on a fixed interval, so a stalled pipeline still reports.
+class DecodePipeline {
+public:
+    using ApplyFunction = std::function<void(DecodedFrame&)>;
+
+    DecodePipeline(asio::thread_pool& workers, ApplyFunction apply, const std::string& name, size_t maxInFlight);
+    ~DecodePipeline();
+
+    void submit(const ServerFrame& frame, long elapsedTime);
+    void submitDecoded(const std::string& type, const json& data);
+    void stop();
+
+private:
+    asio::thread_pool& workers;
+    ApplyFunction apply;
+    std::string name;
+    size_t maxInFlight;
+
+    mutable std::mutex mutex;
+    std::condition_variable readyCondition;
+    std::condition_variable spaceCondition;
+    std::condition_variable stopCondition;
+    std::map<uint64_t, std::shared_ptr<DecodedFrame>> completed;
+    uint64_t nextOrdinal = 0;
+    uint64_t nextToApply = 0;
+    std::atomic<size_t> decoding;
+    bool stopping = false;
+    boost::thread applyThread;
+    boost::thread reportThread;
+
+    uint64_t framesApplied = 0;
+    double decodeMillisTotal = 0;
+    double waitMillisTotal = 0;
+    double applyMillisTotal = 0;
+    uint64_t intervalFrames = 0;
+
+    bool reserveOrdinal(uint64_t& ordinal);
+    void decode(const std::shared_ptr<DecodedFrame>& decoded, uint8_t codec, std::vector<char> payload);
+    void complete(const std::shared_ptr<DecodedFrame>& decoded);
+    void applyLoop();
+    void recordApplied(const DecodedFrame& decoded, std::chrono::steady_clock::time_point applyStart);
+    void reportLoop();
+};
+
+#endif // DECODE_PIPELINE_HPP
@@ -0,0 +1,42 @@
+#ifndef DENSITY_MAP_H
+#define DENSITY_MAP_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <boost/asio/thread_pool.hpp>
+#include <SFML/Graphics.hpp>
+
+#include "Particle.hpp"
+
+// Low-detail particle view: particles are binned into a coarse grid over the world
+// and drawn as a single texture, so the draw cost depends on the grid size only.
+// Binning runs on a pool kept for the lifetime of the map, since it happens every frame.
+class DensityMap : public sf::Drawable {
+public:
+    DensityMap(int cellSize = 4);
+
+    void clear();
+    // Also collects, in screen coordinates, the particles within radius of focus so the caller can
+    // draw them individually without another pass. A radius of 0 collects none.
+    void accumulate(const std::vector<Particle>& particles, const sf::Vector2f& focus, float radius,
+                    std::vector<sf::Vector2f>& nearFocus);
+    void upload();
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+private:
+    int cellSize;
+    int columns;
+    int rows;
+    std::vector<uint32_t> counts;
+    std::vector<sf::Uint8> pixels;
+    sf::Texture texture;
+    sf::Sprite sprite;
+    boost::asio::thread_pool workers;
+
+    void binRange(const std::vector<Particle>& particles, size_t begin, size_t end, std::vector<uint32_t>& grid,
+                  const sf::Vector2f& focus, float radius, std::vector<sf::Vector2f>& nearFocus) const;
+};
+
+#endif // DENSITY_MAP_H
@@ -18,6 +18,7 @@ public:
     void moveRight();
     
     void revertMove();
+    void markMoved();
     void updateCoords(double x, double y);
 
     void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
@@ -0,0 +1,29 @@
+#ifndef FRAME_TIME_HISTOGRAM_H
+#define FRAME_TIME_HISTOGRAM_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Fixed-width histogram of frame times, used for percentiles that show stutter
+// which an average frame rate hides.
+class FrameTimeHistogram {
+public:
+    FrameTimeHistogram(double bucketMillis = 0.1, double maxMillis = 100.0);
+
+    void record(double frameMillis);
+    void merge(const FrameTimeHistogram& other);
+    void reset();
+
+    uint64_t getCount() const;
+    double percentile(double p) const;
+
+    bool exportCSV(const std::string& path) const;
+
+private:
+    double bucketMillis;
+    std::vector<uint64_t> buckets; // last bucket collects everything above maxMillis
+    uint64_t count;
+};
+
+#endif // FRAME_TIME_HISTOGRAM_H
@@ -0,0 +1,70 @@
+#ifndef LOAD_GENERATOR_HPP
+#define LOAD_GENERATOR_HPP
+
+#include <boost/asio.hpp>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "ClientServer.hpp"
+
+using boost::asio::ip::tcp;
+namespace asio = boost::asio;
+using boost::system::error_code;
+
+enum class MovePattern { Idle, Line, Circle, Random };
+
+struct ClientStats {
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    uint64_t decodeErrors = 0;
+    uint64_t movesSent = 0;
+    double decodeMillis = 0;
+    std::vector<long long> latencies;
+};
+
+// A headless explorer client: moves along a scripted pattern and consumes every broadcast.
+// All clients share one io_context, so everything here runs on the io_context thread.
+class SimulatedClient : public std::enable_shared_from_this<SimulatedClient> {
+public:
+    SimulatedClient(asio::io_context& io_context, int index, MovePattern pattern, int moveIntervalMs);
+
+    void start(const tcp::resolver::results_type& endpoints);
+    void stop();
+
+    int getIndex() const;
+    bool isConnected() const;
+    const ClientStats& getStats() const;
+
+private:
+    void readMore();
+    void consumeFrames();
+    void scheduleMove();
+    void advancePattern();
+    void sendMove();
+
+    tcp::socket socket;
+    asio::steady_timer moveTimer;
+    std::vector<char> readBuffer;
+    std::vector<char> pending;
+    std::vector<char> outgoing;
+    bool writing = false;
+    bool connected = false;
+
+    int index;
+    MovePattern pattern;
+    int moveIntervalMs;
+    int step = 0;
+    double x_coord;
+    double y_coord;
+    double originX;
+    double originY;
+    int direction = 1;
+    std::mt19937 rng;
+
+    ClientStats stats;
+};
+
+#endif // LOAD_GENERATOR_HPP
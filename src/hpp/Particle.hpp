@@ -1,29 +1,39 @@
 #ifndef PARTICLE_H
 #define PARTICLE_H
 
-#include <SFML/Graphics.hpp>
+#include "Precision.hpp"
 
-class Particle : public sf::Drawable {
+// Plain data, so shards can keep particles by value in one contiguous array.
+// SimulationPanel draws them with a single shared shape.
+// Instantiated for float and double in Particle.cpp.
+template <typename Real>
+class BasicParticle {
 public:
-    Particle(double x, double y, double velocity, double angle);
+    BasicParticle();
+    BasicParticle(Real x, Real y, Real velocity, Real angle, int id = -1);
 
-    void updatePosition(double time);
+    void updatePosition(Real time);
 
-    double getXCoord() const;
-    double getYCoord() const;
-    double getAngle() const;
-    double getVelocity() const;
-    double getVelocityX() const;
-    double getVelocityY() const;
-    
-    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+    int getID() const;
+    // Index of the server connection the particle came from. IDs are only unique per server.
+    void setOrigin(int origin);
+    int getOrigin() const;
+    Real getXCoord() const;
+    Real getYCoord() const;
+    Real getAngle() const;
+    Real getVelocity() const;
+    Real getVelocityX() const;
+    Real getVelocityY() const;
 
 private:
-    double x_coord;
-    double y_coord;
-    double velocity;
-    double angle;
-    sf::CircleShape shape;
+    int id;
+    int origin;
+    Real x_coord;
+    Real y_coord;
+    Real velocity;
+    Real angle;
 };
 
+using Particle = BasicParticle<SimReal>;
+
 #endif // PARTICLE_H
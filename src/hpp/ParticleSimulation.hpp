@@ -16,13 +16,19 @@ public:
     void updateSimulationLoop();
     void run();
     void applyZoomAndCenter(sf::RenderWindow& window, double x, double y);
+    void setRenderPacing(int targetFPS, bool vsync);
+    void setRegions(const std::vector<sf::FloatRect>& regions);
+    void setParticleReordering(int intervalTicks, SpaceFillingCurve curve);
 
     void setID(const json& jsonData);
+    int getID() const;
     bool getIsRunning() const;
 
-    void addParticle(const json& jsonData , long elapsedTime);
-    void addOtherExplorer(const json& jsonData);
-    void removeExplorer(const json& jsonData);
+    void addParticles(const std::vector<Particle>& decoded, size_t regionIndex);
+    void addOtherExplorer(const json& jsonData, size_t regionIndex);
+    void removeExplorer(const json& jsonData, size_t regionIndex);
+    void removeParticles(const json& jsonData, size_t regionIndex);
+    void resetRegion(size_t regionIndex);
 
     void setIsRunning();
 
@@ -32,6 +38,8 @@ private:
     SimulationPanel simulationPanel;
     std::atomic<bool> isRunning = true;
     double zoomFactor = 1.94;
+    int targetFPS = 60;
+    bool vsync = false;
     int ID = -1;
 };
 
@@ -0,0 +1,61 @@
+#ifndef PAYLOAD_CODEC_HPP
+#define PAYLOAD_CODEC_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Codec ids as they appear on the wire. Once a connection has negotiated codecs, every
+// frame carries one of these in the byte after its sequence number.
+enum class CodecID : uint8_t {
+    Raw = 0,
+    Gzip = 1,
+    LZ4 = 2,
+    Dictionary = 3
+};
+
+// Turns the JSON body of a frame into wire bytes and back. The server picks a codec per
+// message from the ones the connection accepted, so the client must be able to decode all of them.
+class PayloadCodec {
+public:
+    virtual ~PayloadCodec() = default;
+
+    virtual CodecID getID() const = 0;
+    virtual std::string getName() const = 0;
+    virtual std::vector<char> encode(const std::string& data) const = 0;
+    virtual std::string decode(const std::vector<char>& payload) const = 0;
+};
+
+const std::vector<const PayloadCodec*>& getPayloadCodecs();
+const PayloadCodec* findPayloadCodec(uint8_t id);
+const PayloadCodec* findPayloadCodec(const std::string& name);
+std::string decodePayload(uint8_t codec, const std::vector<char>& payload);
+
+// Must match PayloadCodec.DICTIONARY on the server; zlib rejects payloads built with another dictionary.
+const std::string& getPayloadDictionary();
+
+// One frame body as it came off the wire, kept for CodecBenchmark.
+struct RecordedPayload {
+    std::string type;
+    uint8_t codec = static_cast<uint8_t>(CodecID::Gzip);
+    std::vector<char> payload;
+};
+
+// Appends received frame bodies to a file so codecs can be compared on real traffic.
+class PayloadRecorder {
+public:
+    explicit PayloadRecorder(const std::string& path);
+
+    bool isOpen() const;
+    void record(const std::string& type, uint8_t codec, const std::vector<char>& payload);
+
+private:
+    std::ofstream file;
+    std::mutex fileMutex;
+};
+
+bool readPayloadRecording(const std::string& path, std::vector<RecordedPayload>& payloads);
+
+#endif // PAYLOAD_CODEC_HPP
@@ -0,0 +1,15 @@
+#ifndef PRECISION_H
+#define PRECISION_H
+
+// Floating point type of the client particle pipeline, chosen with the
+// PARTICLE_SINGLE_PRECISION CMake option. A 1280x720 world does not need double;
+// PrecisionTest checks the error float adds against the double path.
+// Only the four state values shrink: each particle still owns an sf::CircleShape and shards
+// hold pointers to particles, so float brings no memory bandwidth or SIMD gain by itself.
+#ifdef PARTICLE_SINGLE_PRECISION
+using SimReal = float;
+#else
+using SimReal = double;
+#endif
+
+#endif // PRECISION_H
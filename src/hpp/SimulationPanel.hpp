@@ -9,11 +9,17 @@
 #include <boost/thread.hpp>
 #include <mutex>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <nlohmann/json.hpp>
 #include <SFML/Graphics.hpp>
 
 #include "Particle.hpp"
 #include "Explorer.hpp"
+#include "DensityMap.hpp"
+#include "SimulationShard.hpp"
+#include "FrameTimeHistogram.hpp"
+#include "SpatialOrder.hpp"
 
 using json = nlohmann::json;
 
@@ -22,24 +28,55 @@ public:
 
     SimulationPanel();
 
-    void parseJSONToParticles(const json& jsonData, long elapsedTime);
-    void parseJSONToExplorers(const json& jsonData, const std::string& type);
+    void setRegions(const std::vector<sf::FloatRect>& regions);
+    size_t getShardCount() const;
+    void setParticleReordering(int intervalTicks, SpaceFillingCurve curve);
+
+    static Particle decodeParticle(const json& obj);
+    static Particle decodeExtrapolatedParticle(const json& jsonData, long elapsedTime);
+
+    void addParticles(const std::vector<Particle>& decoded, size_t regionIndex);
+    void parseJSONToExplorers(const json& jsonData, const std::string& type, size_t regionIndex);
+    void removeParticles(const json& jsonData, size_t regionIndex);
     void addExplorer(int ID, double x, double y);
     const std::shared_ptr<Explorer>& getExplorer() const;
 
-    void updateSimulation();
+    void setViewRect(const sf::FloatRect& rect);
+    sf::FloatRect getViewRect() const;
+
+    void updateSimulation(size_t shardIndex);
+    void resetRegion(size_t regionIndex);
+
+    void recordFrame(double frameMillis);
+    bool exportFrameTimes(const std::string& path) const;
     
     void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 
 private:
-    std::vector<std::shared_ptr<Particle>> particles;
+    std::vector<std::unique_ptr<SimulationShard>> shards;
     std::vector<std::shared_ptr<Explorer>> explorers;
+    // The regions currently reporting each explorer. An explorer stays until none of them does.
+    std::unordered_map<int, std::unordered_set<size_t>> explorerSources;
     std::shared_ptr<Explorer> explorer;
-    int frameCount;
-    int previousFPS;
-    std::chrono::time_point<std::chrono::high_resolution_clock> lastFPSCheck;
+    mutable std::mutex stateMutex;
+    sf::FloatRect viewRect;
+    int renderFrameCount;
+    int previousRenderFPS;
+    std::chrono::time_point<std::chrono::high_resolution_clock> lastRenderFPSCheck;
+    std::chrono::time_point<std::chrono::high_resolution_clock> lastHistogramCheck;
+    FrameTimeHistogram frameTimes;
+    FrameTimeHistogram sessionFrameTimes;
+    double frameTimeP50;
+    double frameTimeP95;
+    double frameTimeP99;
     sf::Font font;
+    mutable DensityMap densityMap;
+    int reorderInterval = 0;
+    SpaceFillingCurve reorderCurve = SpaceFillingCurve::Hilbert;
 
+    void placeParticle(const Particle& particle, size_t fallbackIndex);
+    void dropExplorerSource(int id, size_t regionIndex);
+    bool useDensityMap(const sf::RenderTarget& target, size_t particleCount) const;
     void drawFPSInfo(sf::RenderTarget& target) const;
 };
 
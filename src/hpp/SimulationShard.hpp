@@ -0,0 +1,91 @@
+#ifndef SIMULATION_SHARD_H
+#define SIMULATION_SHARD_H
+
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <unordered_set>
+#include <cstdint>
+#include <SFML/Graphics.hpp>
+
+#include "Particle.hpp"
+#include "Precision.hpp"
+#include "SpatialOrder.hpp"
+
+// The particles of one world region. Each shard is stepped by its own thread;
+// particles that move into another region are returned to the caller to be handed to that region's shard.
+// Particles outside every region, such as on the far world edge, stay with the shard that holds them.
+// Particles are stored by value in one array, which can be re-sorted along a space-filling curve every few ticks
+// so neighbours sit next to each other in memory.
+// Instantiated for float and double in SimulationShard.cpp.
+template <typename Real>
+class BasicSimulationShard {
+public:
+    using ParticleType = BasicParticle<Real>;
+
+    BasicSimulationShard(int index, const sf::FloatRect& bounds);
+
+    void addParticle(const ParticleType& particle);
+    void handOff(const ParticleType& particle);
+    void update(Real time, std::vector<ParticleType>& leaving);
+    void removeParticles(int origin, const std::unordered_set<int>& ids);
+    void removeOrigin(int origin);
+
+    void setReordering(int intervalTicks, SpaceFillingCurve curve);
+    void setOtherRegions(const std::vector<sf::FloatRect>& regions);
+    bool reorder();
+
+    bool contains(double x, double y) const;
+    int getIndex() const;
+    size_t size() const;
+    int getTicksPerSecond() const;
+
+    template <typename Function>
+    void withParticles(Function function) const {
+        std::lock_guard<std::mutex> lock(particleMutex);
+        function(particles);
+    }
+
+private:
+    int index;
+    sf::FloatRect bounds;
+    std::vector<sf::FloatRect> otherRegions;
+    std::vector<ParticleType> particles;
+    std::vector<ParticleType> inbox;
+    mutable std::mutex particleMutex;
+    std::mutex inboxMutex;
+
+    int reorderInterval;
+    int ticksSinceReorder;
+    SpaceFillingCurve reorderCurve;
+    // Bumped under particleMutex whenever particles are added or removed, so a reorder
+    // computed outside the lock can tell whether it still matches the stored set.
+    uint64_t membershipVersion;
+    bool sortByCurve();
+    bool ownedElsewhere(double x, double y) const;
+
+    // Drops matching particles from both the inbox and the stepped set.
+    template <typename Predicate>
+    void removeIf(Predicate predicate) {
+        auto isRemoved = [&predicate](const ParticleType& particle) {
+            return predicate(particle);
+        };
+        {
+            std::lock_guard<std::mutex> lock(inboxMutex);
+            inbox.erase(std::remove_if(inbox.begin(), inbox.end(), isRemoved), inbox.end());
+        }
+        std::lock_guard<std::mutex> lock(particleMutex);
+        particles.erase(std::remove_if(particles.begin(), particles.end(), isRemoved), particles.end());
+        membershipVersion++;
+    }
+
+    int tickCount;
+    std::atomic<int> ticksPerSecond;
+    std::chrono::time_point<std::chrono::high_resolution_clock> lastTickCheck;
+};
+
+using SimulationShard = BasicSimulationShard<SimReal>;
+
+#endif // SIMULATION_SHARD_H
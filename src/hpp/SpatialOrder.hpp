@@ -0,0 +1,24 @@
+#ifndef SPATIAL_ORDER_HPP
+#define SPATIAL_ORDER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Curves used to lay particles out in memory so that particles close in space are close in storage.
+enum class SpaceFillingCurve {
+    Morton,
+    Hilbert
+};
+
+bool parseSpaceFillingCurve(const std::string& name, SpaceFillingCurve& curve);
+
+// Keys for a 65536 x 65536 grid. Hilbert keeps neighbours together better, Morton is cheaper to compute.
+uint32_t mortonKey(uint32_t x, uint32_t y);
+uint32_t hilbertKey(uint32_t x, uint32_t y);
+uint32_t curveKey(SpaceFillingCurve curve, uint32_t x, uint32_t y);
+
+// Stable LSD radix sort of values by key. Each pass is split across threads for large inputs.
+void radixSortByKey(std::vector<uint32_t>& keys, std::vector<uint32_t>& values);
+
+#endif // SPATIAL_ORDER_HPP